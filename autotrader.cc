@@ -16,9 +16,11 @@
 //     License along with Ready Trader Go.  If not, see
 //     <https://www.gnu.org/licenses/>.
 #include <array>
+#include <cmath>
 
 #include <boost/asio/io_context.hpp>
 
+#include <ready_trader_go/fastlog.h>
 #include <ready_trader_go/logging.h>
 
 #include "autotrader.h"
@@ -34,14 +36,12 @@ using namespace ReadyTraderGo;
 
 RTG_INLINE_GLOBAL_LOGGER_WITH_CHANNEL(LG_AT, "AUTO")
 
-constexpr int LOT_SIZE = 20;
-constexpr int POSITION_LIMIT = 100;
 constexpr int TICK_SIZE_IN_CENTS = 100;
+constexpr FixedRatio PARITY = FixedRatio::FromInteger(1);
 
-constexpr int WINDOW_SIZE = 50;   // Moving average window size.
-constexpr float BAND_WIDTH = 3.5; // Width of the bollinger band.
-
-AutoTrader::AutoTrader(boost::asio::io_context &context) : BaseAutoTrader(context)
+AutoTrader::AutoTrader(boost::asio::io_context &context,
+                       const AutoTraderParameters &parameters) : StaticAutoTrader(context), params(parameters), bandWidth(FixedRatio::FromDouble(parameters.bandWidth)), ratios({parameters.windowSize}),
+                                                                         mHedger(parameters.hedgeWindow, TICK_SIZE_IN_CENTS)
 {
 }
 
@@ -56,91 +56,136 @@ void AutoTrader::ErrorMessageHandler(unsigned long clientOrderId,
 {
     RLOG(LG_AT, LogLevel::LL_INFO) << "error with order " << clientOrderId << ": " << errorMessage;
     if (clientOrderId != 0)
+    {
+        mHedger.OnHedgeRejected(clientOrderId);
+        OrderStatusMessageHandler(clientOrderId, 0, 0, 0);
+    }
+}
+
+void AutoTrader::RiskRejectionHandler(RequestType type,
+                                      unsigned long clientOrderId,
+                                      RiskCheck reason)
+{
+    RLOG(LG_AT, LogLevel::LL_WARNING) << "request for order " << clientOrderId << " not sent: " << reason;
+    // A queued insert refused when it was due to be sent was recorded as
+    // live, so forget it as if the exchange had rejected it.
+    if (type == RequestType::INSERT)
     {
         OrderStatusMessageHandler(clientOrderId, 0, 0, 0);
     }
+    else if (type == RequestType::HEDGE)
+    {
+        mHedger.OnHedgeRejected(clientOrderId);
+    }
 }
 
 void AutoTrader::HedgeFilledMessageHandler(unsigned long clientOrderId,
                                            unsigned long price,
                                            unsigned long volume)
 {
-    RLOG(LG_AT, LogLevel::LL_INFO) << "hedge order " << clientOrderId << " filled for " << volume
-                                   << " lots at $" << price << " average price in cents";
+    FLOG(LG_AT, LogLevel::LL_INFO, "hedge order {} filled for {} lots at ${} average price in cents",
+         clientOrderId, volume, price);
+    mHedger.OnHedgeFilled(GetRiskGate().Now(), clientOrderId, volume);
+    sendHedge();
 }
 
-void AutoTrader::OrderBookMessageHandler(Instrument instrument,
-                                         unsigned long sequenceNumber,
-                                         const std::array<unsigned long, TOP_LEVEL_COUNT> &askPrices,
-                                         const std::array<unsigned long, TOP_LEVEL_COUNT> &askVolumes,
-                                         const std::array<unsigned long, TOP_LEVEL_COUNT> &bidPrices,
-                                         const std::array<unsigned long, TOP_LEVEL_COUNT> &bidVolumes)
+void AutoTrader::OrderBookMessageHandler(const OrderBookView &book)
 {
-    RLOG(LG_AT, LogLevel::LL_INFO) << "order book received for " << instrument << " instrument"
-                                   << ": ask prices: " << askPrices[0]
-                                   << "; ask volumes: " << askVolumes[0]
-                                   << "; bid prices: " << bidPrices[0]
-                                   << "; bid volumes: " << bidVolumes[0];
+    const Instrument instrument = book.GetInstrument();
 
-    setMidpoint(instrument, bidPrices[0], askPrices[0]);
+    FLOG(LG_AT, LogLevel::LL_INFO, "order book received for {} instrument: ask prices: {}; ask volumes: {}"
+         "; bid prices: {}; bid volumes: {}",
+         instrument, book.AskPrices()[0], book.AskVolumes()[0], book.BidPrices()[0], book.BidVolumes()[0]);
 
-    if (instrument == Instrument::ETF)
+    // Most updates leave the top of the book as it was.
+    const MarketState &market = GetMarket();
+    const BookChanges changes = market.GetBooks().GetChanges(instrument);
+    if (instrument == Instrument::FUTURE && changes != BookChange::NONE)
+    {
+        mHedger.OnFutureBook(book);
+    }
+    sendHedge();
+
+    if (!market.HasRatio())
+    {
+        return;
+    }
+
+    // ETF updates clock the bollinger bands; a future update only matters
+    // if it moved the ratio.
+    if (instrument == Instrument::FUTURE && !(changes & BookChange::BEST_PRICES))
     {
-        float ratio = (float)midpointETF / (float)midpointFuture;
-        RLOG(LG_AT, LogLevel::LL_INFO) << "ratio: " << ratio;
+        return;
+    }
+
+    const FixedRatio ratio = market.GetRatio();
+    FLOG(LG_AT, LogLevel::LL_INFO, "ratio: {}", ratio.ToDouble());
 
-        // Check if current pair trading opportunity has expired.
-        if (mAskId != 0 && ratio <= 1)
+    // Check if current pair trading opportunity has expired.
+    if (mAskId != 0 && ratio <= PARITY)
+    {
+        if (SendCancelOrder(mAskId))
         {
-            SendCancelOrder(mAskId);
-            RLOG(LG_AT, LogLevel::LL_INFO) << "sell order " << mAskId << " cancelled ";
+            FLOG(LG_AT, LogLevel::LL_INFO, "sell order {} cancelled ", mAskId);
             mAskId = 0;
         }
-        if (mBidId != 0 && ratio >= 1)
+    }
+    if (mBidId != 0 && ratio >= PARITY)
+    {
+        if (SendCancelOrder(mBidId))
         {
-            SendCancelOrder(mBidId);
-            RLOG(LG_AT, LogLevel::LL_INFO) << "buy order " << mBidId << " cancelled ";
+            FLOG(LG_AT, LogLevel::LL_INFO, "buy order {} cancelled ", mBidId);
             mBidId = 0;
         }
+    }
 
-        // Set the high/low bollinger bands.
+    // Set the high/low bollinger bands.
+    if (instrument == Instrument::ETF)
+    {
         bollingerBands(ratio);
-        if (sequenceNumber < WINDOW_SIZE)
+    }
+    if (market.GetBooks().GetSequenceNumber(Instrument::ETF) < params.windowSize)
+    {
+        return;
+    }
+
+    const unsigned long bestAsk = market.GetBestAsk(Instrument::ETF);
+    const unsigned long bestBid = market.GetBestBid(Instrument::ETF);
+
+    // Check if a pair trading opportunity exists.
+    if (mBidId == 0 && ratio < lowBollingerBand && ratio < PARITY && mPosition < params.positionLimit)
+    {
+        int volume = params.lotSize;
+        // Check position will not be exceded
+        if (mPosition + volume >= params.positionLimit)
+        {
+            volume = params.positionLimit - abs(mPosition);
+        }
+
+        unsigned long bidId = mNextMessageId++;
+        if (SendInsertOrder(bidId, Side::BUY, bestAsk, volume, Lifespan::GOOD_FOR_DAY))
         {
-            return;
+            mBidId = bidId;
+            FLOG(LG_AT, LogLevel::LL_INFO, "sending buy order {} bid price: {}", mBidId, bestAsk);
+            mOrders.Insert(mBidId, Side::BUY, bestAsk, volume);
         }
+    }
 
-        // Check if a pair trading opportunity exists.
-        if (mBidId == 0 && ratio < lowBollingerBand && ratio < 1 && mPosition < POSITION_LIMIT)
+    if (mAskId == 0 && ratio > highBollingerBand && ratio > PARITY && mPosition > -params.positionLimit)
+    {
+        int volume = params.lotSize;
+        // Check position will not be exceded
+        if (mPosition - volume <= -params.positionLimit)
         {
-            int volume = LOT_SIZE;
-            // Check position will not be exceded
-            if (mPosition + volume >= POSITION_LIMIT)
-            {
-                volume = POSITION_LIMIT - abs(mPosition);
-            }
-
-            mBidId = mNextMessageId++;
-            SendInsertOrder(mBidId, Side::BUY, askPrices[0], volume, Lifespan::GOOD_FOR_DAY);
-            RLOG(LG_AT, LogLevel::LL_INFO) << "sending buy order " << mBidId
-                                           << " bid price: " << midpointFuture;
-            mBids.emplace(mBidId);
+            volume = params.positionLimit - abs(mPosition);
         }
 
-        if (mAskId == 0 && ratio > highBollingerBand && ratio > 1 && mPosition > -POSITION_LIMIT)
+        unsigned long askId = mNextMessageId++;
+        if (SendInsertOrder(askId, Side::SELL, bestBid, volume, Lifespan::GOOD_FOR_DAY))
         {
-            int volume = LOT_SIZE;
-            // Check position will not be exceded
-            if (mPosition - volume <= -POSITION_LIMIT)
-            {
-                volume = POSITION_LIMIT - abs(mPosition);
-            }
-
-            mAskId = mNextMessageId++;
-            SendInsertOrder(mAskId, Side::SELL, bidPrices[0], volume, Lifespan::GOOD_FOR_DAY);
-            RLOG(LG_AT, LogLevel::LL_INFO) << "sending sell order " << mAskId
-                                           << " ask price: " << midpointFuture;
-            mAsks.emplace(mAskId);
+            mAskId = askId;
+            FLOG(LG_AT, LogLevel::LL_INFO, "sending sell order {} ask price: {}", mAskId, bestBid);
+            mOrders.Insert(mAskId, Side::SELL, bestBid, volume);
         }
     }
 }
@@ -149,18 +194,17 @@ void AutoTrader::OrderFilledMessageHandler(unsigned long clientOrderId,
                                            unsigned long price,
                                            unsigned long volume)
 {
-    RLOG(LG_AT, LogLevel::LL_INFO) << "order " << clientOrderId << " filled for " << volume
-                                   << " lots at $" << price << " cents";
-    if (mAsks.count(clientOrderId) == 1)
-    {
-        mPosition -= (long)volume;
-        SendHedgeOrder(mNextMessageId++, Side::BUY, MAXIMUM_ASK / TICK_SIZE_IN_CENTS * TICK_SIZE_IN_CENTS, volume);
-    }
-    else if (mBids.count(clientOrderId) == 1)
+    FLOG(LG_AT, LogLevel::LL_INFO, "order {} filled for {} lots at ${} cents", clientOrderId, volume, price);
+    TrackedOrder *order = mOrders.Find(clientOrderId);
+    if (order == nullptr)
     {
-        mPosition += (long)volume;
-        SendHedgeOrder(mNextMessageId++, Side::SELL, MINIMUM_BID, volume);
+        return;
     }
+
+    mOrders.Fill(*order, volume);
+    mPosition += (order->mSide == Side::BUY) ? (long)volume : -(long)volume;
+    mHedger.OnOrderFilled(GetRiskGate().Now(), order->mSide, volume);
+    sendHedge();
 }
 
 void AutoTrader::OrderStatusMessageHandler(unsigned long clientOrderId,
@@ -168,9 +212,8 @@ void AutoTrader::OrderStatusMessageHandler(unsigned long clientOrderId,
                                            unsigned long remainingVolume,
                                            signed long fees)
 {
-    RLOG(LG_AT, LogLevel::LL_INFO) << "order " << clientOrderId << " was updated. filled: " << fillVolume
-                                   << " remaining: " << remainingVolume
-                                   << " fees: " << fees;
+    FLOG(LG_AT, LogLevel::LL_INFO, "order {} was updated. filled: {} remaining: {} fees: {}",
+         clientOrderId, fillVolume, remainingVolume, fees);
     if (remainingVolume == 0)
     {
         if (clientOrderId == mAskId)
@@ -182,8 +225,11 @@ void AutoTrader::OrderStatusMessageHandler(unsigned long clientOrderId,
             mBidId = 0;
         }
 
-        mAsks.erase(clientOrderId);
-        mBids.erase(clientOrderId);
+        mOrders.Erase(clientOrderId);
+    }
+    else if (TrackedOrder *order = mOrders.Find(clientOrderId))
+    {
+        mOrders.Update(*order, remainingVolume);
     }
 }
 
@@ -194,74 +240,38 @@ void AutoTrader::TradeTicksMessageHandler(Instrument instrument,
                                           const std::array<unsigned long, TOP_LEVEL_COUNT> &bidPrices,
                                           const std::array<unsigned long, TOP_LEVEL_COUNT> &bidVolumes)
 {
-    RLOG(LG_AT, LogLevel::LL_INFO) << "trade ticks received for " << instrument << " instrument"
-                                   << ": ask prices: " << askPrices[0]
-                                   << "; ask volumes: " << askVolumes[0]
-                                   << "; bid prices: " << bidPrices[0]
-                                   << "; bid volumes: " << bidVolumes[0];
+    FLOG(LG_AT, LogLevel::LL_INFO, "trade ticks received for {} instrument: ask prices: {}; ask volumes: {}"
+         "; bid prices: {}; bid volumes: {}",
+         instrument, askPrices[0], askVolumes[0], bidPrices[0], bidVolumes[0]);
 }
 
-void AutoTrader::setMidpoint(Instrument instrument,
-                             unsigned long bidPrice,
-                             unsigned long askPrice)
+void AutoTrader::sendHedge()
 {
-    // Check for undefined division.
-    if (bidPrice == 0 || askPrice == 0)
+    HedgeOrder hedge;
+    if (!mHedger.NextHedge(GetRiskGate().Now(), hedge))
     {
         return;
     }
 
-    if (instrument == Instrument::FUTURE)
-    {
-        midpointFuture = (askPrice + bidPrice) / 2;
-        if (midpointFuture % 100 != 0)
-        {
-            midpointFuture += 50;
-        }
-    }
-
-    if (instrument == Instrument::ETF)
-    {
-        midpointETF = (askPrice + bidPrice) / 2;
-        if (midpointETF % 100 != 0)
-        {
-            midpointETF += 50;
-        }
-    }
+    // Recorded first, as a rejection is reported from inside SendHedgeOrder.
+    unsigned long hedgeId = mNextMessageId++;
+    mHedger.OnHedgeSent(GetRiskGate().Now(), hedgeId, hedge);
+    FLOG(LG_AT, LogLevel::LL_INFO, "sending hedge order {} for {} lots at {}", hedgeId, hedge.mVolume, hedge.mPrice);
+    SendHedgeOrder(hedgeId, hedge.mSide, hedge.mPrice, hedge.mVolume);
 }
 
-void AutoTrader::bollingerBands(float ratio)
+void AutoTrader::bollingerBands(FixedRatio ratio)
 {
-    float sum = 0;
-
-    if (ratios.size() < WINDOW_SIZE)
+    // The bands are first set once a full window precedes the new ratio.
+    bool isWindowFull = ratios.IsFull();
+    ratios.Push(ratio);
+    if (isWindowFull)
     {
-        ratios.push_back(ratio);
-    }
-    else
-    {
-        ratios.erase(ratios.begin());
-        ratios.push_back(ratio);
-
-        // Calculate the moving average.
-        sum = 0;
-        for (int i = 0; i < WINDOW_SIZE; i++)
-        {
-            sum += ratios[i];
-        }
-        MA = sum / WINDOW_SIZE;
-
-        // Calculate the moving standard deviation.
-        sum = 0;
-        for (int i = 0; i < WINDOW_SIZE; i++)
-        {
-            sum += pow(ratios[i] - MA, 2);
-        }
-        SD = sqrt(sum / WINDOW_SIZE);
+        MA = ratios.GetMean();
+        SD = ratios.GetStandardDeviation();
 
         // Set the bollinger band.
-        highBollingerBand = MA + BAND_WIDTH * SD;
-        lowBollingerBand = MA - BAND_WIDTH * SD;
+        highBollingerBand = MA + bandWidth * SD;
+        lowBollingerBand = MA - bandWidth * SD;
     }
-    return;
 }
@@ -21,17 +21,32 @@
 #include <array>
 #include <memory>
 #include <string>
-#include <unordered_set>
 
 #include <boost/asio/io_context.hpp>
 
 #include <ready_trader_go/baseautotrader.h>
+#include <ready_trader_go/fixedpoint.h>
+#include <ready_trader_go/hedgeengine.h>
+#include <ready_trader_go/ordertable.h>
+#include <ready_trader_go/rollingstatistics.h>
+#include <ready_trader_go/staticautotrader.h>
 #include <ready_trader_go/types.h>
 
-class AutoTrader : public ReadyTraderGo::BaseAutoTrader
+// Tunable settings for the strategy.
+struct AutoTraderParameters
+{
+    unsigned long windowSize = 50; // Moving average window size.
+    float bandWidth = 3.5;         // Width of the bollinger band.
+    long lotSize = 20;             // Volume of each order.
+    long positionLimit = 100;      // Largest position the strategy will take.
+    double hedgeWindow = 1.0;      // Seconds over which fills are netted into one hedge.
+};
+
+class AutoTrader final : public ReadyTraderGo::StaticAutoTrader<AutoTrader>
 {
 public:
-    explicit AutoTrader(boost::asio::io_context &context);
+    explicit AutoTrader(boost::asio::io_context &context,
+                        const AutoTraderParameters &parameters = AutoTraderParameters{});
 
     // Called when the execution connection is lost.
     void DisconnectHandler() override;
@@ -42,6 +57,12 @@ public:
     void ErrorMessageHandler(unsigned long clientOrderId,
                              const std::string &errorMessage) override;
 
+    // Called when a request is not sent because it would exceed one of the
+    // exchange's limits.
+    void RiskRejectionHandler(ReadyTraderGo::RequestType type,
+                              unsigned long clientOrderId,
+                              ReadyTraderGo::RiskCheck reason) override;
+
     // Called when one of your hedge orders is filled, partially or fully.
     //
     // The price is the average price at which the order was (partially) filled,
@@ -57,13 +78,8 @@ public:
     // The sequence number can be used to detect missed or out-of-order
     // messages. The five best available ask (i.e. sell) and bid (i.e. buy)
     // prices are reported along with the volume available at each of those
-    // price levels.
-    void OrderBookMessageHandler(ReadyTraderGo::Instrument instrument,
-                                 unsigned long sequenceNumber,
-                                 const std::array<unsigned long, ReadyTraderGo::TOP_LEVEL_COUNT> &askPrices,
-                                 const std::array<unsigned long, ReadyTraderGo::TOP_LEVEL_COUNT> &askVolumes,
-                                 const std::array<unsigned long, ReadyTraderGo::TOP_LEVEL_COUNT> &bidPrices,
-                                 const std::array<unsigned long, ReadyTraderGo::TOP_LEVEL_COUNT> &bidVolumes) override;
+    // price levels. Fields are decoded from the message only when read.
+    void OrderBookMessageHandler(const ReadyTraderGo::OrderBookView &book) override;
 
     // Called when one of your orders is filled, partially or fully.
     void OrderFilledMessageHandler(unsigned long clientOrderId,
@@ -93,31 +109,30 @@ public:
                                   const std::array<unsigned long, ReadyTraderGo::TOP_LEVEL_COUNT> &bidPrices,
                                   const std::array<unsigned long, ReadyTraderGo::TOP_LEVEL_COUNT> &bidVolumes) override;
 
-    // Calculate the midpoint price of the given instrument.
-    void setMidpoint(ReadyTraderGo::Instrument instrument,
-                     unsigned long bidPrice,
-                     unsigned long askPrice);
-
     // Calculate the bollinger bands
-    void bollingerBands(float ratio);
+    void bollingerBands(ReadyTraderGo::FixedRatio ratio);
+
+    // Send the hedge, if any, that the hedge engine says is due.
+    void sendHedge();
 
 private:
-    unsigned long midpointETF = 1;    // Midpoint between the best bid and ask price for the ETF.
-    unsigned long midpointFuture = 1; // Midpoint between the best bid and ask price for the Future.
-    float MA = 0;                     // Moving average.
-    float SD = 0;                     // Moving standard deviation.
-    std::vector<float> ratios;        // Last 20 recorded ratios.
+    AutoTraderParameters params;
+
+    ReadyTraderGo::FixedRatio bandWidth;   // params.bandWidth as a fixed-point number.
+    ReadyTraderGo::FixedRatio MA;          // Moving average.
+    ReadyTraderGo::FixedRatio SD;          // Moving standard deviation.
+    ReadyTraderGo::FixedRollingStatistics<ReadyTraderGo::FixedRatio> ratios; // Ratios recorded in the current window.
 
-    float lowBollingerBand = 1;
-    float highBollingerBand = 1;
+    ReadyTraderGo::FixedRatio lowBollingerBand = ReadyTraderGo::FixedRatio::FromInteger(1);
+    ReadyTraderGo::FixedRatio highBollingerBand = ReadyTraderGo::FixedRatio::FromInteger(1);
 
     unsigned long mNextMessageId = 1;
     unsigned long mAskId = 0;
     unsigned long mBidId = 0;
 
     signed long mPosition = 0; // Current postion of the autotrader
-    std::unordered_set<unsigned long> mAsks;
-    std::unordered_set<unsigned long> mBids;
+    ReadyTraderGo::OrderTable mOrders; // Outstanding (non-hedge) orders.
+    ReadyTraderGo::HedgeEngine mHedger; // Nets fills into hedges.
 };
 
 #endif // CPPREADY_TRADER_GO_AUTOTRADER_H
@@ -0,0 +1,110 @@
+// Copyright 2021 Optiver Asia Pacific Pty. Ltd.
+//
+// This file is part of Ready Trader Go.
+//
+//     Ready Trader Go is free software: you can redistribute it and/or
+//     modify it under the terms of the GNU Affero General Public License
+//     as published by the Free Software Foundation, either version 3 of
+//     the License, or (at your option) any later version.
+//
+//     Ready Trader Go is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU Affero General Public License for more details.
+//
+//     You should have received a copy of the GNU Affero General Public
+//     License along with Ready Trader Go.  If not, see
+//     <https://www.gnu.org/licenses/>.
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <boost/asio/io_context.hpp>
+#include <boost/log/core/core.hpp>
+#include <boost/property_tree/json_parser.hpp>
+#include <boost/property_tree/ptree.hpp>
+
+#include <ready_trader_go/error.h>
+#include <ready_trader_go/marketdata.h>
+#include <ready_trader_go/simulator.h>
+
+#include "autotrader.h"
+
+using namespace ReadyTraderGo;
+
+namespace {
+
+void printResult(const std::string& filename, const SimulationResult& result)
+{
+    const CompetitorAccount& account = result.mAccount;
+    std::cout << filename << '\n'
+              << "  status:          " << result.mStatus;
+    if (!result.mReason.empty())
+    {
+        std::cout << " (" << result.mReason << ")";
+    }
+    std::cout << '\n' << std::fixed << std::setprecision(2)
+              << "  end time:        " << result.mEndTime << "s\n"
+              << "  profit or loss:  " << account.mProfitOrLoss / 100.0 << '\n'
+              << "  max drawdown:    " << account.mMaxDrawdown / 100.0 << '\n'
+              << "  total fees:      " << account.mTotalFees / 100.0 << '\n'
+              << "  etf position:    " << account.mEtfPosition << '\n'
+              << "  future position: " << account.mFuturePosition << '\n'
+              << "  buy volume:      " << account.mBuyVolume << '\n'
+              << "  sell volume:     " << account.mSellVolume << '\n'
+              << "  fills:           " << result.mFillCount << '\n'
+              << "  hedges:          " << result.mHedgeCount << '\n'
+              << "  messages:        " << result.mMessageCount << '\n'
+              << "  errors:          " << result.mErrorCount << '\n'
+              << "  market events:   " << result.mMarketEventCount << std::endl;
+}
+
+}
+
+// Replay one or more market data files (CSV or binary) through the auto-trader using the
+// limits and fees in exchange.json, printing the outcome of each match.
+int main(int argc, char* argv[])
+{
+    if (argc < 2)
+    {
+        std::cerr << "usage: " << argv[0] << " MARKET_DATA_FILE..." << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    // The auto-trader's logging would dominate the run time.
+    boost::log::core::get()->set_logging_enabled(false);
+
+    try
+    {
+        boost::property_tree::ptree tree;
+        boost::property_tree::read_json("exchange.json", tree);
+        SimulatorConfig config;
+        config.readFromPropertyTree(tree);
+
+        for (int i = 1; i < argc; ++i)
+        {
+            auto events = OpenMarketData(argv[i]);
+            boost::asio::io_context context;
+            AutoTrader trader{context};
+            trader.SetLoginDetails("Backtest", "secret");
+
+            Simulator simulator{config, *events};
+            simulator.Attach(trader);
+            printResult(argv[i], simulator.Run());
+        }
+    }
+    catch (const boost::property_tree::ptree_error& e)
+    {
+        std::cerr << "failed while reading configuration: " << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+    catch (const ReadyTraderGoError& e)
+    {
+        std::cerr << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,50 @@
+// Copyright 2021 Optiver Asia Pacific Pty. Ltd.
+//
+// This file is part of Ready Trader Go.
+//
+//     Ready Trader Go is free software: you can redistribute it and/or
+//     modify it under the terms of the GNU Affero General Public License
+//     as published by the Free Software Foundation, either version 3 of
+//     the License, or (at your option) any later version.
+//
+//     Ready Trader Go is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU Affero General Public License for more details.
+//
+//     You should have received a copy of the GNU Affero General Public
+//     License along with Ready Trader Go.  If not, see
+//     <https://www.gnu.org/licenses/>.
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+#include <ready_trader_go/error.h>
+#include <ready_trader_go/marketdata.h>
+
+using namespace ReadyTraderGo;
+
+// Convert a market data CSV file to the binary columnar format read by the
+// backtester.
+int main(int argc, char* argv[])
+{
+    if (argc != 3)
+    {
+        std::cerr << "usage: " << argv[0] << " CSV_FILE BINARY_FILE" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    try
+    {
+        MarketDataCsvReader events{argv[1]};
+        std::uint64_t count = WriteMarketDataFile(events, argv[2]);
+        std::cout << "wrote " << count << " market events to " << argv[2] << std::endl;
+    }
+    catch (const ReadyTraderGoError& e)
+    {
+        std::cerr << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,177 @@
+// Copyright 2021 Optiver Asia Pacific Pty. Ltd.
+//
+// This file is part of Ready Trader Go.
+//
+//     Ready Trader Go is free software: you can redistribute it and/or
+//     modify it under the terms of the GNU Affero General Public License
+//     as published by the Free Software Foundation, either version 3 of
+//     the License, or (at your option) any later version.
+//
+//     Ready Trader Go is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU Affero General Public License for more details.
+//
+//     You should have received a copy of the GNU Affero General Public
+//     License along with Ready Trader Go.  If not, see
+//     <https://www.gnu.org/licenses/>.
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <sys/resource.h>
+
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/ip/tcp.hpp>
+#include <boost/asio/write.hpp>
+#include <boost/log/core/core.hpp>
+
+#include <ready_trader_go/connectivity.h>
+#include <ready_trader_go/error.h>
+#include <ready_trader_go/protocol.h>
+#include <ready_trader_go/uringconnection.h>
+
+using namespace ReadyTraderGo;
+using Clock = std::chrono::steady_clock;
+
+namespace {
+
+// Accept one connection and write back everything received on it.
+void echo(tcp::acceptor& acceptor)
+{
+    boost::system::error_code error;
+    tcp::socket socket = acceptor.accept();
+    socket.set_option(tcp::no_delay(true), error);
+    std::array<unsigned char, 4096> buffer;
+    while (true)
+    {
+        std::size_t size = socket.read_some(boost::asio::buffer(buffer), error);
+        if (error)
+            break;
+        boost::asio::write(socket, boost::asio::buffer(buffer.data(), size), error);
+        if (error)
+            break;
+    }
+}
+
+double threadCpuSeconds()
+{
+    rusage usage{};
+    getrusage(RUSAGE_THREAD, &usage);
+    return usage.ru_utime.tv_sec + usage.ru_stime.tv_sec
+           + (usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) / 1e6;
+}
+
+// Send count amend messages, one at a time, through an execution connection
+// of the given transport to a local echo server and report the round trip
+// times and the CPU time the client's io_context thread used (which leaves
+// out a pipelined connection's own thread).
+void run(const std::string& transport, bool isSqPoll, int count, bool isPipelined = false)
+{
+    boost::asio::io_context serverContext;
+    tcp::acceptor acceptor{serverContext, tcp::endpoint{boost::asio::ip::address_v4::loopback(), 0}};
+    std::thread server{[&acceptor] { echo(acceptor); }};
+
+    std::vector<std::uint64_t> roundTrips;
+    roundTrips.reserve(count);
+    double cpuSeconds;
+    try
+    {
+        boost::asio::io_context context;
+        ExecutionOptions options;
+        options.mTransport = transport;
+        options.mIsSqPoll = isSqPoll;
+        options.mIsPipelined = isPipelined;
+        ConnectionFactory factory{context, "127.0.0.1", acceptor.local_endpoint().port(), options};
+        std::unique_ptr<IConnection> connection = factory.Create();
+
+        Clock::time_point sentAt;
+        auto send = [&] {
+            sentAt = Clock::now();
+            connection->SendMessage(MessageType::AMEND_ORDER, AmendMessage{roundTrips.size() + 1, 1});
+        };
+        connection->Disconnected = [&context] { context.stop(); };
+        connection->MessageReceived = [&](IConnection*, unsigned char, unsigned char const*, std::size_t) {
+            roundTrips.push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - sentAt).count());
+            if (roundTrips.size() < static_cast<std::size_t>(count))
+                send();
+            else
+                context.stop();
+        };
+
+        double cpuStart = threadCpuSeconds();
+        send();
+        connection->AsyncRead();
+        context.run();
+        cpuSeconds = threadCpuSeconds() - cpuStart;
+    }
+    catch (...)
+    {
+        // The echo server stops once the client's socket is closed.
+        server.join();
+        throw;
+    }
+    server.join();
+
+    std::sort(roundTrips.begin(), roundTrips.end());
+    auto percentile = [&roundTrips](double p) {
+        return roundTrips[std::min(roundTrips.size() - 1, static_cast<std::size_t>(p * roundTrips.size()))] / 1000.0;
+    };
+    std::uint64_t total = 0;
+    for (auto rtt : roundTrips)
+        total += rtt;
+    std::cout << std::left << std::setw(16)
+              << (transport + (isSqPoll ? "+sqpoll" : "") + (isPipelined ? "+pipeline" : "")) << std::right
+              << std::fixed << std::setprecision(2)
+              << std::setw(10) << total / 1000.0 / roundTrips.size()
+              << std::setw(10) << percentile(0.5)
+              << std::setw(10) << percentile(0.99)
+              << std::setw(10) << percentile(0.999)
+              << std::setw(12) << cpuSeconds * 1e6 / roundTrips.size() << std::endl;
+}
+
+}
+
+// Compare the round trip latency of the execution transports against a
+// local echo server standing in for the exchange.
+int main(int argc, char* argv[])
+{
+    int count = (argc > 1) ? std::atoi(argv[1]) : 100000;
+    if (argc > 2 || count <= 0)
+    {
+        std::cerr << "usage: " << argv[0] << " [ROUND_TRIPS]" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    boost::log::core::get()->set_logging_enabled(false);
+
+    std::cout << "round trip times in microseconds over " << count << " messages\n"
+              << std::left << std::setw(16) << "transport" << std::right
+              << std::setw(10) << "mean" << std::setw(10) << "p50" << std::setw(10) << "p99"
+              << std::setw(10) << "p99.9" << std::setw(12) << "cpu/msg" << std::endl;
+    try
+    {
+        run("asio", false, count);
+        run("busypoll", false, count);
+        run("asio", false, count, true);
+        if (IsUringAvailable())
+        {
+            run("io_uring", false, count);
+            run("io_uring", true, count);
+        }
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
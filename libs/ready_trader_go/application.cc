@@ -34,6 +34,8 @@
 
 #include "application.h"
 #include "error.h"
+#include "fastlog.h"
+#include "latency.h"
 #include "logging.h"
 
 namespace logging = boost::log;
@@ -110,11 +112,30 @@ void Application::Run(int argc, char* argv[])
     mSignals.add(SIGTERM);
 #ifdef SIGQUIT
     mSignals.add(SIGQUIT);
+#endif
+#ifdef SIGUSR1
+    // Report latency statistics on demand
+    mSignals.add(SIGUSR1);
 #endif
     mSignals.async_wait([this](const boost::system::error_code& ec, int s) { SignalHandler(ec, s); });
 
     OnReadyToRun();
     mContext.run();
+    LogLatencyStatistics();
+}
+
+void Application::LogLatencyStatistics()
+{
+    if constexpr (!LATENCY_STATS_ENABLED)
+    {
+        RLOG(LG_APP, LogLevel::LL_INFO) << "latency statistics are not enabled in this build";
+        return;
+    }
+
+    for (auto& line : GetLatencyRecorder().Report())
+    {
+        RLOG(LG_APP, LogLevel::LL_INFO) << "latency " << line;
+    }
 }
 
 void Application::SetUpLogging()
@@ -145,10 +166,21 @@ void Application::SetUpLogging()
 #ifdef NDEBUG
     mSink->set_filter(rtg_severity > LogLevel::LL_DEBUG);
 #endif
+
+    GetFastLogger().Start();
 }
 
 void Application::SignalHandler(const boost::system::error_code& error, int signal)
 {
+#ifdef SIGUSR1
+    if (!error && signal == SIGUSR1)
+    {
+        LogLatencyStatistics();
+        mSignals.async_wait([this](const boost::system::error_code& ec, int s) { SignalHandler(ec, s); });
+        return;
+    }
+#endif
+
     if (!error)
     {
         RLOG(LG_APP, LogLevel::LL_INFO) << "application received signal " << signal << ", shutting down";
@@ -168,6 +200,7 @@ void Application::SignalHandler(const boost::system::error_code& error, int sign
 
 void Application::TearDownLogging()
 {
+    GetFastLogger().Stop();
     if (mSink)
     {
         logging::core::get()->remove_sink(mSink);
@@ -61,6 +61,7 @@ private:
     void OnReadyToRun() const;
 
     void LoadConfig(const std::string& filename);
+    void LogLatencyStatistics();
     void SetUpLogging();
     void SignalHandler(const boost::system::error_code& error, int signal);
     void TearDownLogging();
@@ -39,12 +39,16 @@ void AutoTraderAppHandler::ConfigLoadedHandler(const boost::property_tree::ptree
 
     mExecConnectionFactory = std::make_unique<ConnectionFactory>(mContext,
                                                                  config.mExecHost,
-                                                                 config.mExecPort);
+                                                                 config.mExecPort,
+                                                                 config.mExecOptions);
     mInfoSubscriptionFactory = std::make_unique<SubscriptionFactory>(mContext,
                                                                      config.mInfoType,
-                                                                     config.mInfoName);
+                                                                     config.mInfoName,
+                                                                     config.mInfoMode,
+                                                                     config.mInfoCpu);
 
     mAutoTrader.SetLoginDetails(config.mTeamName, config.mSecret);
+    mAutoTrader.SetRiskLimits(config.mLimits);
 }
 
 void AutoTraderAppHandler::ReadyToRunHandler()
@@ -17,6 +17,7 @@
 //     <https://www.gnu.org/licenses/>.
 #include "baseautotrader.h"
 #include "error.h"
+#include "latency.h"
 #include "logging.h"
 #include "protocol.h"
 
@@ -24,15 +25,20 @@ RTG_INLINE_GLOBAL_LOGGER_WITH_CHANNEL(LG_BAT, "BASE")
 
 namespace ReadyTraderGo {
 
+void BaseAutoTrader::BindHandlers(IConnection& connection)
+{
+    connection.Disconnected = [this] { DisconnectHandler(); };
+    connection.MessageReceived = [this](IConnection* c,
+                                        unsigned char t,
+                                        unsigned char const* d,
+                                        std::size_t s) { MessageHandler(c, t, d, s); };
+}
+
 void BaseAutoTrader::SetExecutionConnection(std::unique_ptr<IConnection>&& connection)
 {
     mExecutionConnection = std::move(connection);
     mExecutionConnection->SetName("Exec");
-    mExecutionConnection->Disconnected = [this] { DisconnectHandler(); };
-    mExecutionConnection->MessageReceived = [this](IConnection* c,
-                                                   unsigned char t,
-                                                   unsigned char const* d,
-                                                   std::size_t s) { MessageHandler(c, t, d, s); };
+    BindHandlers(*mExecutionConnection);
 
     RLOG(LG_BAT, LogLevel::LL_INFO) << "logging in with teamname='" << mTeamName
                                     << "' and secret='" << mSecret << '\'';
@@ -42,45 +48,91 @@ void BaseAutoTrader::SetExecutionConnection(std::unique_ptr<IConnection>&& conne
     mExecutionConnection->AsyncRead();
 }
 
+bool BaseAutoTrader::QueueRequest(const QueuedRequest& request)
+{
+    if (!mRateShaper.Push(request))
+    {
+        RiskRejectionHandler(request.mType, request.mClientOrderId, RiskCheck::REQUEST_QUEUE_LIMIT);
+        return false;
+    }
+    // Released when the batch is committed, so that a refusal is never
+    // reported to a handler from inside one of its own requests.
+    return true;
+}
+
+void BaseAutoTrader::ReleaseQueuedRequests()
+{
+    while (const QueuedRequest* next = mRateShaper.Front())
+    {
+        std::size_t reserve = (next->mType == RequestType::INSERT) ? mRateShaper.GetInsertReserve() : 0;
+        if (!mRiskGate.HasMessageBudget(reserve))
+        {
+            break;
+        }
+        QueuedRequest request = *next;
+        mRateShaper.Pop();
+        SendRequest(request);
+    }
+
+    // Reported only when a batch is committed so that a strategy's handler
+    // is not re-entered from one of its own requests.
+    unsigned long clientOrderId;
+    while (mRateShaper.PopUnsentOrder(clientOrderId))
+    {
+        OrderStatusMessageHandler(clientOrderId, 0, 0, 0);
+    }
+}
+
+void BaseAutoTrader::RiskRejectionHandler(RequestType type, unsigned long clientOrderId, RiskCheck reason)
+{
+    RLOG(LG_BAT, LogLevel::LL_WARNING) << "request for order " << clientOrderId
+                                       << " not sent: it would exceed the " << reason;
+}
+
+void BaseAutoTrader::SetRiskLimits(const RiskLimits& limits)
+{
+    mRiskGate.SetLimits(limits);
+    mRateShaper.SetMessageFrequencyLimit(limits.mMessageFrequencyLimit);
+}
+
 void BaseAutoTrader::MessageHandler(IConnection* connection,
                                     unsigned char messageType,
                                     unsigned char const* data,
                                     std::size_t size)
 {
+    SendBatch batch(*this);
+
     switch (messageType)
     {
     case MessageType::ERROR_MESSAGE:
     {
-        auto err = makeMessage<ErrorMessage>(data, size);
+        auto err = BeforeErrorMessage(data, size);
         ErrorMessageHandler(err.mClientOrderId, err.mMessage);
         break;
     }
     case MessageType::HEDGE_FILLED:
     {
-        auto filled = makeMessage<HedgeFilledMessage>(data, size);
+        auto filled = BeforeHedgeFilledMessage(data, size);
         HedgeFilledMessageHandler(filled.mClientOrderId, filled.mPrice, filled.mVolume);
         break;
     }
     case MessageType::ORDER_FILLED:
     {
-        auto filled = makeMessage<OrderFilledMessage>(data, size);
+        auto filled = BeforeOrderFilledMessage(data, size);
         OrderFilledMessageHandler(filled.mClientOrderId, filled.mPrice, filled.mVolume);
         break;
     }
     case MessageType::ORDER_STATUS:
     {
-        auto status = makeMessage<OrderStatusMessage>(data, size);
+        auto status = BeforeOrderStatusMessage(data, size);
         OrderStatusMessageHandler(status.mClientOrderId, status.mFillVolume,
                                   status.mRemainingVolume, status.mFees);
         break;
     }
     default:
-    {
-        RLOG(LG_BAT, LogLevel::LL_ERROR) << "received execution message with unexpected type: "
-                                         << static_cast<int>(messageType);
-        throw ReadyTraderGoError("received execution message with unexpected type");
-    }
+        UnexpectedMessage("execution", messageType);
     }
+    RTG_LATENCY_POINT(HandlerExited());
 }
 
 void BaseAutoTrader::MessageHandler(ISubscription* subscription,
@@ -88,29 +140,31 @@ void BaseAutoTrader::MessageHandler(ISubscription* subscription,
                                     unsigned char const* data,
                                     std::size_t size)
 {
+    SendBatch batch(*this);
+
     switch (messageType)
     {
     case MessageType::ORDER_BOOK_UPDATE:
-    {
-        auto book = makeMessage<OrderBookMessage>(data, size);
-        OrderBookMessageHandler(book.mInstrument, book.mSequenceNumber, book.mAskPrices,
-                                book.mAskVolumes, book.mBidPrices, book.mBidVolumes);
+        OrderBookMessageHandler(BeforeOrderBookMessage(data, size));
         break;
-    }
     case MessageType::TRADE_TICKS:
     {
-        auto ticks = makeMessage<TradeTicksMessage>(data, size);
+        auto ticks = BeforeTradeTicksMessage(data, size);
         TradeTicksMessageHandler(ticks.mInstrument, ticks.mSequenceNumber, ticks.mAskPrices,
                                  ticks.mAskVolumes, ticks.mBidPrices, ticks.mBidVolumes);
         break;
     }
     default:
-    {
-        RLOG(LG_BAT, LogLevel::LL_ERROR) << "received information message with unexpected type: "
-                                         << static_cast<int>(messageType);
-        throw ReadyTraderGoError("received information message with unexpected type");
-    }
+        UnexpectedMessage("information", messageType);
     }
+    RTG_LATENCY_POINT(HandlerExited());
+}
+
+void BaseAutoTrader::UnexpectedMessage(const char* source, unsigned char messageType)
+{
+    RLOG(LG_BAT, LogLevel::LL_ERROR) << "received " << source << " message with unexpected type: "
+                                     << static_cast<int>(messageType);
+    throw ReadyTraderGoError(std::string("received ") + source + " message with unexpected type");
 }
 
 }
\ No newline at end of file
@@ -27,8 +27,13 @@
 
 #include <boost/asio/io_context.hpp>
 
+#include "bookcache.h"
 #include "connectivitytypes.h"
+#include "latency.h"
+#include "marketstate.h"
 #include "protocol.h"
+#include "rateshaper.h"
+#include "riskgate.h"
 #include "types.h"
 
 namespace ReadyTraderGo {
@@ -38,30 +43,71 @@ class BaseAutoTrader
 public:
     explicit BaseAutoTrader(boost::asio::io_context& context) : mContext(context) {};
 
-    virtual void SendAmendOrder(unsigned long clientOrderId, unsigned long volume);
-    virtual void SendCancelOrder(unsigned long clientOrderId);
-    virtual void SendHedgeOrder(unsigned long clientOrderId,
+    // Each request is first checked by the risk gate. If the request would
+    // exceed one of the exchange's limits, it is not sent, the risk
+    // rejection handler is called and false is returned.
+    //
+    // When the message frequency budget is nearly spent, requests are queued
+    // by the rate shaper and true is returned. Queued requests are sent,
+    // cancels first, as budget becomes available when the outermost batch is
+    // committed, and one that is then refused by the risk gate is reported to
+    // the risk rejection handler. An order whose insert is still queued when
+    // it is cancelled is never sent and is reported to the order status
+    // handler as cancelled.
+    virtual bool SendAmendOrder(unsigned long clientOrderId, unsigned long volume);
+    virtual bool SendCancelOrder(unsigned long clientOrderId);
+    virtual bool SendHedgeOrder(unsigned long clientOrderId,
                                 Side side,
                                 unsigned long price,
                                 unsigned long volume);
-    virtual void SendInsertOrder(unsigned long clientOrderId,
+    virtual bool SendInsertOrder(unsigned long clientOrderId,
                                  Side side,
                                  unsigned long price,
                                  unsigned long volume,
                                  Lifespan lifespan);
 
+    // Requests sent between BeginBatch and the matching CommitBatch are
+    // written to the execution connection together, in a single write, when
+    // the outermost batch is committed. Every message handler runs inside a
+    // batch, so all the requests a handler sends leave together, along with
+    // any queued requests for which there is budget by then.
+    void BeginBatch() noexcept { ++mBatchDepth; }
+    void CommitBatch();
+
     virtual void SetExecutionConnection(std::unique_ptr<IConnection>&& connection);
     virtual void SetInformationSubscription(std::shared_ptr<ISubscription>&& subscription);
     virtual void SetLoginDetails(std::string teamName, std::string secret);
+    virtual void SetRiskLimits(const RiskLimits& limits);
+
+    RiskGate& GetRiskGate() noexcept { return mRiskGate; }
+
+    // The latest order book and trade ticks of each instrument. They are
+    // updated before the corresponding message handler is called, so an
+    // order book handler can check which levels changed and read derived
+    // values for either instrument.
+    const BookCache& GetBooks() const noexcept { return mMarket.GetBooks(); }
+    const MarketState& GetMarket() const noexcept { return mMarket; }
 
 protected:
     boost::asio::io_context& mContext;
     std::unique_ptr<IConnection> mExecutionConnection = nullptr;
     std::shared_ptr<ISubscription> mInformationSubscription = nullptr;
+    RiskGate mRiskGate;
+    MarketState mMarket;
+    RateShaper mRateShaper{mRiskGate.GetLimits().mMessageFrequencyLimit};
+    unsigned int mBatchDepth = 0;
+    // Indexed by side.
+    std::array<HedgeMessageTemplate, 2> mHedgeTemplates{HedgeMessageTemplate{Side::SELL},
+                                                       HedgeMessageTemplate{Side::BUY}};
 
     std::string mTeamName;
     std::string mSecret;
 
+    // Install the callbacks through which the connection and subscription
+    // deliver messages to this auto-trader.
+    virtual void BindHandlers(IConnection& connection);
+    virtual void BindHandlers(ISubscription& subscription);
+
     virtual void DisconnectHandler();
     virtual void MessageHandler(IConnection*, unsigned char, unsigned char const*, std::size_t);
     virtual void MessageHandler(ISubscription* subscription,
@@ -69,6 +115,33 @@ protected:
                                 unsigned char const* data,
                                 std::size_t size);
 
+    // The bookkeeping that precedes the handler of each received message:
+    // each of these decodes a message, updates the risk gate or market state
+    // with it and starts timing the handler. Every dispatcher calls them, so
+    // dispatchers differ only in how they call the handler.
+    ErrorMessage BeforeErrorMessage(unsigned char const* data, std::size_t size);
+    HedgeFilledMessage BeforeHedgeFilledMessage(unsigned char const* data, std::size_t size);
+    OrderFilledMessage BeforeOrderFilledMessage(unsigned char const* data, std::size_t size);
+    OrderStatusMessage BeforeOrderStatusMessage(unsigned char const* data, std::size_t size);
+    OrderBookView BeforeOrderBookMessage(unsigned char const* data, std::size_t size);
+    TradeTicksMessage BeforeTradeTicksMessage(unsigned char const* data, std::size_t size);
+
+    // Log and throw for a message of a type that cannot arrive from source.
+    [[noreturn]] void UnexpectedMessage(const char* source, unsigned char messageType);
+
+    // Send queued requests for which there is now message budget and report
+    // orders that were cancelled before they were sent.
+    void ServiceRateShaper()
+    {
+        if (!mRateShaper.IsEmpty())
+        {
+            ReleaseQueuedRequests();
+        }
+    }
+
+    // Called when the risk gate stops a request from being sent.
+    virtual void RiskRejectionHandler(RequestType type, unsigned long clientOrderId, RiskCheck reason);
+
     // Message callbacks
     virtual void ErrorMessageHandler(unsigned long clientOrderId,
                                      const std::string& errorMessage) {};
@@ -81,6 +154,10 @@ protected:
                                          const std::array<unsigned long, TOP_LEVEL_COUNT>& askVolumes,
                                          const std::array<unsigned long, TOP_LEVEL_COUNT>& bidPrices,
                                          const std::array<unsigned long, TOP_LEVEL_COUNT>& bidVolumes) {};
+    // Called with a view over the received order book message. By default
+    // this decodes every field and calls the overload above; override it to
+    // read only the fields a strategy needs.
+    virtual void OrderBookMessageHandler(const OrderBookView& book);
     virtual void OrderFilledMessageHandler(unsigned long clientOrderId,
                                            unsigned long price,
                                            unsigned long volume) {};
@@ -94,60 +171,230 @@ protected:
                                           const std::array<unsigned long, TOP_LEVEL_COUNT>& askVolumes,
                                           const std::array<unsigned long, TOP_LEVEL_COUNT>& bidPrices,
                                           const std::array<unsigned long, TOP_LEVEL_COUNT>& bidVolumes) {};
+
+private:
+    bool QueueRequest(const QueuedRequest& request);
+    void ReleaseQueuedRequests();
+    bool SendRequest(const QueuedRequest& request);
+};
+
+// Sends the requests made during its lifetime as one batch.
+class SendBatch
+{
+public:
+    explicit SendBatch(BaseAutoTrader& autoTrader) noexcept : mAutoTrader(autoTrader) { mAutoTrader.BeginBatch(); }
+    // Committing sends queued requests, which may throw.
+    ~SendBatch() noexcept(false) { mAutoTrader.CommitBatch(); }
+
+    SendBatch(const SendBatch&) = delete;
+    SendBatch& operator=(const SendBatch&) = delete;
+
+private:
+    BaseAutoTrader& mAutoTrader;
 };
 
+inline ErrorMessage BaseAutoTrader::BeforeErrorMessage(unsigned char const* data, std::size_t size)
+{
+    auto err = makeMessage<ErrorMessage>(data, size);
+    mRiskGate.OnError(err.mClientOrderId);
+    RTG_LATENCY_POINT(Decoded());
+    RTG_LATENCY_POINT(HandlerEntered());
+    return err;
+}
+
+inline HedgeFilledMessage BaseAutoTrader::BeforeHedgeFilledMessage(unsigned char const* data, std::size_t size)
+{
+    auto filled = makeMessage<HedgeFilledMessage>(data, size);
+    mRiskGate.OnHedgeFilled(filled.mClientOrderId, filled.mVolume);
+    RTG_LATENCY_POINT(Decoded());
+    RTG_LATENCY_POINT(HandlerEntered());
+    return filled;
+}
+
+inline OrderFilledMessage BaseAutoTrader::BeforeOrderFilledMessage(unsigned char const* data, std::size_t size)
+{
+    auto filled = makeMessage<OrderFilledMessage>(data, size);
+    mRiskGate.OnOrderFilled(filled.mClientOrderId, filled.mVolume);
+    RTG_LATENCY_POINT(Decoded());
+    RTG_LATENCY_POINT(HandlerEntered());
+    return filled;
+}
+
+inline OrderStatusMessage BaseAutoTrader::BeforeOrderStatusMessage(unsigned char const* data, std::size_t size)
+{
+    auto status = makeMessage<OrderStatusMessage>(data, size);
+    mRiskGate.OnOrderStatus(status.mClientOrderId, status.mRemainingVolume);
+    RTG_LATENCY_POINT(Decoded());
+    RTG_LATENCY_POINT(HandlerEntered());
+    return status;
+}
+
+inline OrderBookView BaseAutoTrader::BeforeOrderBookMessage(unsigned char const* data, std::size_t size)
+{
+    OrderBookView book{data, size};
+    mMarket.OnOrderBook(book);
+    RTG_LATENCY_POINT(Decoded());
+    RTG_LATENCY_POINT(HandlerEntered());
+    return book;
+}
+
+inline TradeTicksMessage BaseAutoTrader::BeforeTradeTicksMessage(unsigned char const* data, std::size_t size)
+{
+    auto ticks = makeMessage<TradeTicksMessage>(data, size);
+    mMarket.OnTradeTicks(ticks);
+    RTG_LATENCY_POINT(Decoded());
+    RTG_LATENCY_POINT(HandlerEntered());
+    return ticks;
+}
+
+inline void BaseAutoTrader::BindHandlers(ISubscription& subscription)
+{
+    subscription.MessageReceived = [this](ISubscription* s,
+                                          unsigned char t,
+                                          unsigned char const* d,
+                                          std::size_t z) { MessageHandler(s, t, d, z); };
+}
+
+inline void BaseAutoTrader::CommitBatch()
+{
+    // Released while the batch is still open so that they are deferred and
+    // written with the rest of it.
+    if (mBatchDepth == 1)
+    {
+        ServiceRateShaper();
+    }
+    if (--mBatchDepth == 0 && mExecutionConnection)
+    {
+        mExecutionConnection->Flush();
+    }
+}
+
 inline void BaseAutoTrader::DisconnectHandler()
 {
     mContext.stop();
 }
 
+inline void BaseAutoTrader::OrderBookMessageHandler(const OrderBookView& book)
+{
+    auto message = book.ToMessage();
+    OrderBookMessageHandler(message.mInstrument, message.mSequenceNumber, message.mAskPrices,
+                            message.mAskVolumes, message.mBidPrices, message.mBidVolumes);
+}
+
 inline void BaseAutoTrader::SetInformationSubscription(std::shared_ptr<ISubscription>&& subscription)
 {
     mInformationSubscription = std::move(subscription);
     mInformationSubscription->SetName("Info");
-    mInformationSubscription->MessageReceived = [this](ISubscription* s,
-                                                       unsigned char t,
-                                                       unsigned char const* d,
-                                                       std::size_t z) { MessageHandler(s, t, d, z); };
+    BindHandlers(*mInformationSubscription);
     mInformationSubscription->AsyncReceive();
 }
 
-inline void BaseAutoTrader::SendAmendOrder(unsigned long clientOrderId, unsigned long volume)
+inline bool BaseAutoTrader::SendAmendOrder(unsigned long clientOrderId, unsigned long volume)
 {
-    mExecutionConnection->SendMessage(MessageType::AMEND_ORDER,
-                                      AmendMessage{clientOrderId, volume});
+    QueuedRequest request{clientOrderId, 0, volume, RequestType::AMEND};
+    if (!mRateShaper.IsEmpty() || !mRiskGate.HasMessageBudget())
+    {
+        return QueueRequest(request);
+    }
+    return SendRequest(request);
 }
 
-inline void BaseAutoTrader::SendCancelOrder(unsigned long clientOrderId)
+inline bool BaseAutoTrader::SendCancelOrder(unsigned long clientOrderId)
 {
-    mExecutionConnection->SendMessage(MessageType::CANCEL_ORDER,
-                                      CancelMessage{clientOrderId});
+    QueuedRequest request{clientOrderId, 0, 0, RequestType::CANCEL};
+    if (!mRateShaper.IsEmpty() || !mRiskGate.HasMessageBudget())
+    {
+        return QueueRequest(request);
+    }
+    return SendRequest(request);
 }
 
-inline void BaseAutoTrader::SendHedgeOrder(unsigned long clientOrderId,
+inline bool BaseAutoTrader::SendHedgeOrder(unsigned long clientOrderId,
                                            Side side,
                                            unsigned long price,
                                            unsigned long volume)
 {
-    mExecutionConnection->SendMessage(MessageType::HEDGE_ORDER,
-                                      HedgeMessage{clientOrderId,
-                                                   side,
-                                                   price,
-                                                   volume});
+    QueuedRequest request{clientOrderId, price, volume, RequestType::HEDGE, side};
+    if (!mRateShaper.IsEmpty() || !mRiskGate.HasMessageBudget())
+    {
+        return QueueRequest(request);
+    }
+    return SendRequest(request);
 }
 
-inline void BaseAutoTrader::SendInsertOrder(unsigned long clientOrderId,
+inline bool BaseAutoTrader::SendInsertOrder(unsigned long clientOrderId,
                                             Side side,
                                             unsigned long price,
                                             unsigned long volume,
                                             Lifespan lifespan)
 {
-    mExecutionConnection->SendMessage(MessageType::INSERT_ORDER,
-                                      InsertMessage{clientOrderId,
-                                                    side,
-                                                    price,
-                                                    volume,
-                                                    lifespan});
+    QueuedRequest request{clientOrderId, price, volume, RequestType::INSERT, side, lifespan};
+    if (!mRateShaper.IsEmpty() || !mRiskGate.HasMessageBudget(mRateShaper.GetInsertReserve()))
+    {
+        return QueueRequest(request);
+    }
+    return SendRequest(request);
+}
+
+inline bool BaseAutoTrader::SendRequest(const QueuedRequest& request)
+{
+    RiskCheck check = RiskCheck::ACCEPTED;
+    switch (request.mType)
+    {
+    case RequestType::AMEND:
+        check = mRiskGate.CheckAmend();
+        break;
+    case RequestType::CANCEL:
+        check = mRiskGate.CheckCancel();
+        break;
+    case RequestType::HEDGE:
+        check = mRiskGate.CheckHedge(request.mClientOrderId, request.mSide, request.mPrice, request.mVolume);
+        break;
+    case RequestType::INSERT:
+        check = mRiskGate.CheckInsert(request.mClientOrderId, request.mSide, request.mPrice, request.mVolume);
+        break;
+    }
+
+    if (check != RiskCheck::ACCEPTED)
+    {
+        RiskRejectionHandler(request.mType, request.mClientOrderId, check);
+        return false;
+    }
+
+    const SendMode mode = (mBatchDepth > 0) ? SendMode::DEFERRED : SendMode::ASAP;
+    switch (request.mType)
+    {
+    case RequestType::AMEND:
+        mExecutionConnection->SendMessage(MessageType::AMEND_ORDER,
+                                          AmendMessage{request.mClientOrderId, request.mVolume},
+                                          mode);
+        break;
+    case RequestType::CANCEL:
+        mExecutionConnection->SendMessage(MessageType::CANCEL_ORDER,
+                                          CancelMessage{request.mClientOrderId},
+                                          mode);
+        break;
+    case RequestType::HEDGE:
+        // Hedges are the most frequent and most urgent request, so they are
+        // sent from a template rather than serialised.
+        mExecutionConnection->SendEncoded(
+            mHedgeTemplates[static_cast<std::size_t>(request.mSide)].Encode(request.mClientOrderId,
+                                                                              request.mPrice,
+                                                                              request.mVolume),
+            HedgeMessageTemplate::SIZE,
+            mode);
+        break;
+    case RequestType::INSERT:
+        mExecutionConnection->SendMessage(MessageType::INSERT_ORDER,
+                                          InsertMessage{request.mClientOrderId,
+                                                        request.mSide,
+                                                        request.mPrice,
+                                                        request.mVolume,
+                                                        request.mLifespan},
+                                          mode);
+        break;
+    }
+    return true;
 }
 
 inline void BaseAutoTrader::SetLoginDetails(std::string teamName, std::string secret)
@@ -0,0 +1,63 @@
+// Copyright 2021 Optiver Asia Pacific Pty. Ltd.
+//
+// This file is part of Ready Trader Go.
+//
+//     Ready Trader Go is free software: you can redistribute it and/or
+//     modify it under the terms of the GNU Affero General Public License
+//     as published by the Free Software Foundation, either version 3 of
+//     the License, or (at your option) any later version.
+//
+//     Ready Trader Go is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU Affero General Public License for more details.
+//
+//     You should have received a copy of the GNU Affero General Public
+//     License along with Ready Trader Go.  If not, see
+//     <https://www.gnu.org/licenses/>.
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include "bookcache.h"
+
+namespace ReadyTraderGo {
+
+// Return a mask of the fields that differ between before and after.
+static inline BookChanges compareLevels(const TopLevels& before, const TopLevels& after) noexcept
+{
+    static_assert(TopLevels::FIELD_COUNT == 20, "SIMD compare assumes twenty fields");
+    BookChanges same = 0;
+#if defined(__SSE2__)
+    for (std::size_t i = 0; i < TopLevels::FIELD_COUNT; i += 4)
+    {
+        const __m128i a = _mm_load_si128((__m128i const*)(before.mFields.data() + i));
+        const __m128i b = _mm_load_si128((__m128i const*)(after.mFields.data() + i));
+        same |= static_cast<BookChanges>(_mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(a, b)))) << i;
+    }
+#else
+    for (std::size_t i = 0; i < TopLevels::FIELD_COUNT; ++i)
+    {
+        same |= static_cast<BookChanges>(before.mFields[i] == after.mFields[i]) << i;
+    }
+#endif
+    return ~same & BookChange::ALL;
+}
+
+BookChanges BookCache::Update(const OrderBookView& book) noexcept
+{
+    Entry& entry = mEntries[static_cast<std::size_t>(book.GetInstrument())];
+
+    TopLevels levels;
+    book.DecodeLevels(levels);
+    entry.mChanges = entry.mIsValid ? compareLevels(entry.mLevels, levels) : BookChange::ALL;
+    if (entry.mChanges != BookChange::NONE)
+    {
+        entry.mLevels = levels;
+    }
+    entry.mSequenceNumber = book.GetSequenceNumber();
+    entry.mIsValid = true;
+    return entry.mChanges;
+}
+
+}
@@ -0,0 +1,93 @@
+// Copyright 2021 Optiver Asia Pacific Pty. Ltd.
+//
+// This file is part of Ready Trader Go.
+//
+//     Ready Trader Go is free software: you can redistribute it and/or
+//     modify it under the terms of the GNU Affero General Public License
+//     as published by the Free Software Foundation, either version 3 of
+//     the License, or (at your option) any later version.
+//
+//     Ready Trader Go is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU Affero General Public License for more details.
+//
+//     You should have received a copy of the GNU Affero General Public
+//     License along with Ready Trader Go.  If not, see
+//     <https://www.gnu.org/licenses/>.
+#ifndef CPPREADY_TRADER_GO_LIBS_READY_TRADER_GO_BOOKCACHE_H
+#define CPPREADY_TRADER_GO_LIBS_READY_TRADER_GO_BOOKCACHE_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#include "protocol.h"
+#include "types.h"
+
+namespace ReadyTraderGo {
+
+// A mask of the fields of a book that changed, in which bit i stands for
+// TopLevels::mFields[i].
+using BookChanges = std::uint32_t;
+
+namespace BookChange {
+
+constexpr BookChanges NONE = 0;
+constexpr BookChanges ASK_PRICES = 0x1Fu;
+constexpr BookChanges ASK_VOLUMES = ASK_PRICES << TOP_LEVEL_COUNT;
+constexpr BookChanges BID_PRICES = ASK_PRICES << (TOP_LEVEL_COUNT * 2);
+constexpr BookChanges BID_VOLUMES = ASK_PRICES << (TOP_LEVEL_COUNT * 3);
+constexpr BookChanges ALL = ASK_PRICES | ASK_VOLUMES | BID_PRICES | BID_VOLUMES;
+
+// The price and volume fields of both sides at the given level.
+constexpr BookChanges Level(std::size_t level) noexcept
+{
+    return (1u | 1u << TOP_LEVEL_COUNT | 1u << (TOP_LEVEL_COUNT * 2) | 1u << (TOP_LEVEL_COUNT * 3)) << level;
+}
+
+constexpr BookChanges BEST_PRICES = 1u | 1u << (TOP_LEVEL_COUNT * 2);
+
+}
+
+// The latest order book of each instrument and which of its fields changed
+// in the most recent update.
+//
+// Each update is decoded into the instrument's snapshot and compared with
+// the previous one, so a strategy can test the mask and skip work when the
+// levels it depends on are unchanged. The first update of an instrument
+// reports every field as changed.
+class BookCache
+{
+public:
+    BookChanges Update(const OrderBookView& book) noexcept;
+
+    BookChanges GetChanges(Instrument instrument) const noexcept
+    {
+        return mEntries[static_cast<std::size_t>(instrument)].mChanges;
+    }
+    const TopLevels& GetLevels(Instrument instrument) const noexcept
+    {
+        return mEntries[static_cast<std::size_t>(instrument)].mLevels;
+    }
+    unsigned long GetSequenceNumber(Instrument instrument) const noexcept
+    {
+        return mEntries[static_cast<std::size_t>(instrument)].mSequenceNumber;
+    }
+
+private:
+    // One cache line of levels followed by the rest of the entry.
+    struct Entry
+    {
+        TopLevels mLevels{};
+        BookChanges mChanges = BookChange::NONE;
+        unsigned long mSequenceNumber = 0;
+        bool mIsValid = false;
+    };
+
+    std::array<Entry, 2> mEntries;
+};
+
+}
+
+#endif //CPPREADY_TRADER_GO_LIBS_READY_TRADER_GO_BOOKCACHE_H
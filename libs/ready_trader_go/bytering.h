@@ -0,0 +1,114 @@
+// Copyright 2021 Optiver Asia Pacific Pty. Ltd.
+//
+// This file is part of Ready Trader Go.
+//
+//     Ready Trader Go is free software: you can redistribute it and/or
+//     modify it under the terms of the GNU Affero General Public License
+//     as published by the Free Software Foundation, either version 3 of
+//     the License, or (at your option) any later version.
+//
+//     Ready Trader Go is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU Affero General Public License for more details.
+//
+//     You should have received a copy of the GNU Affero General Public
+//     License along with Ready Trader Go.  If not, see
+//     <https://www.gnu.org/licenses/>.
+#ifndef CPPREADY_TRADER_GO_LIBS_READY_TRADER_GO_BYTERING_H
+#define CPPREADY_TRADER_GO_LIBS_READY_TRADER_GO_BYTERING_H
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstring>
+
+#include <boost/asio/buffer.hpp>
+
+namespace ReadyTraderGo {
+
+// A fixed-capacity ring of bytes that never allocates after construction.
+// The head and tail are free-running counters masked on access, so readable
+// data and free space are each at most two contiguous spans which can be
+// handed to scatter/gather socket operations directly. Capacity must be a
+// power of two.
+template<std::size_t Capacity>
+class ByteRing
+{
+    static_assert(Capacity > 0 && (Capacity & (Capacity - 1)) == 0, "capacity must be a power of two");
+
+public:
+    static constexpr std::size_t CAPACITY = Capacity;
+
+    std::size_t Size() const noexcept { return mTail - mHead; }
+    std::size_t Free() const noexcept { return Capacity - Size(); }
+
+    // The readable bytes, oldest first.
+    std::array<boost::asio::const_buffer, 2> Data() const noexcept
+    {
+        const std::size_t start = mHead & MASK;
+        const std::size_t first = std::min(Size(), Capacity - start);
+        return {boost::asio::const_buffer(mBytes.data() + start, first),
+                boost::asio::const_buffer(mBytes.data(), Size() - first)};
+    }
+
+    // The free space, to be filled and then committed.
+    std::array<boost::asio::mutable_buffer, 2> Prepare() noexcept
+    {
+        const std::size_t start = mTail & MASK;
+        const std::size_t first = std::min(Free(), Capacity - start);
+        return {boost::asio::mutable_buffer(mBytes.data() + start, first),
+                boost::asio::mutable_buffer(mBytes.data(), Free() - first)};
+    }
+
+    void Commit(std::size_t size) noexcept { mTail += size; }
+    void Consume(std::size_t size) noexcept { mHead += size; }
+
+    unsigned char Peek(std::size_t offset) const noexcept { return mBytes[(mHead + offset) & MASK]; }
+
+    // Return a pointer to the size readable bytes at offset if they do not
+    // wrap around the end of the ring, otherwise nullptr.
+    unsigned char const* Contiguous(std::size_t offset, std::size_t size) const noexcept
+    {
+        const std::size_t start = (mHead + offset) & MASK;
+        return (start + size <= Capacity) ? mBytes.data() + start : nullptr;
+    }
+
+    // Copy size readable bytes at offset, which may wrap, into to.
+    void CopyOut(std::size_t offset, unsigned char* to, std::size_t size) const noexcept
+    {
+        const std::size_t start = (mHead + offset) & MASK;
+        const std::size_t first = std::min(size, Capacity - start);
+        std::memcpy(to, mBytes.data() + start, first);
+        std::memcpy(to + first, mBytes.data(), size - first);
+    }
+
+    // Return a pointer to size bytes of contiguous free space at the tail,
+    // or nullptr if the free space wraps before then.
+    unsigned char* ContiguousSpace(std::size_t size) noexcept
+    {
+        const std::size_t start = mTail & MASK;
+        return (size <= Free() && start + size <= Capacity) ? mBytes.data() + start : nullptr;
+    }
+
+    // Append size bytes, which must not exceed Free(), wrapping as needed.
+    void Write(unsigned char const* from, std::size_t size) noexcept
+    {
+        const std::size_t start = mTail & MASK;
+        const std::size_t first = std::min(size, Capacity - start);
+        std::memcpy(mBytes.data() + start, from, first);
+        std::memcpy(mBytes.data(), from + first, size - first);
+        mTail += size;
+    }
+
+private:
+    static constexpr std::size_t MASK = Capacity - 1;
+
+    std::size_t mHead = 0;
+    std::size_t mTail = 0;
+    std::array<unsigned char, Capacity> mBytes;
+};
+
+}
+
+#endif //CPPREADY_TRADER_GO_LIBS_READY_TRADER_GO_BYTERING_H
@@ -22,6 +22,9 @@
 
 #include <boost/property_tree/ptree.hpp>
 
+#include "connectivitytypes.h"
+#include "riskgate.h"
+
 namespace ReadyTraderGo {
 
 struct Config
@@ -30,22 +33,42 @@ struct Config
     {
         mExecHost = tree.get<std::string>("Execution.Host");
         mExecPort = tree.get<unsigned short>("Execution.Port");
+        const ExecutionOptions defaults;
+        mExecOptions.mTransport = tree.get<std::string>("Execution.Transport", defaults.mTransport);
+        mExecOptions.mIsSqPoll = tree.get<bool>("Execution.SqPoll", defaults.mIsSqPoll);
+        mExecOptions.mSqPollCpu = tree.get<int>("Execution.SqPollCpu", defaults.mSqPollCpu);
+        mExecOptions.mBusyPollTime = tree.get<int>("Execution.BusyPoll", defaults.mBusyPollTime);
+        mExecOptions.mCpu = tree.get<int>("Execution.Cpu", defaults.mCpu);
+        mExecOptions.mIsPipelined = tree.get<bool>("Execution.Pipeline", defaults.mIsPipelined);
+        mExecOptions.mPipelineCpu = tree.get<int>("Execution.PipelineCpu", defaults.mPipelineCpu);
 
         mInfoType = tree.get<std::string>("Information.Type");
         mInfoName = tree.get<std::string>("Information.Name");
+        mInfoMode = tree.get<std::string>("Information.Mode", "poll");
+        mInfoCpu = tree.get<int>("Information.Cpu", -1);
 
         mTeamName = tree.get<std::string>("TeamName");
         mSecret = tree.get<std::string>("Secret");
+
+        if (auto limits = tree.get_child_optional("Limits"))
+        {
+            mLimits.readFromPropertyTree(*limits);
+        }
     }
 
     std::string mExecHost;
     unsigned short mExecPort;
+    ExecutionOptions mExecOptions;
 
     std::string mInfoType;
     std::string mInfoName;
+    std::string mInfoMode;
+    int mInfoCpu;
 
     std::string mTeamName;
     std::string mSecret;
+
+    RiskLimits mLimits;
 };
 
 }
@@ -15,12 +15,22 @@
 //     You should have received a copy of the GNU Affero General Public
 //     License along with Ready Trader Go.  If not, see
 //     <https://www.gnu.org/licenses/>.
+#include <atomic>
 #include <cstddef>
+#include <cstring>
+#include <exception>
 #include <iomanip>
 #include <memory>
 #include <string>
+#include <thread>
 #include <vector>
 
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#include <sys/socket.h>
+#endif
+
 #include <boost/asio/connect.hpp>
 #include <boost/asio/io_context.hpp>
 #include <boost/asio/error.hpp>
@@ -33,7 +43,10 @@
 
 #include "connectivity.h"
 #include "error.h"
+#include "latency.h"
 #include "logging.h"
+#include "protocol.h"
+#include "uringconnection.h"
 
 namespace error = boost::asio::error;
 namespace interprocess = boost::interprocess;
@@ -44,14 +57,61 @@ RTG_INLINE_GLOBAL_LOGGER_WITH_CHANNEL(LG_CON, "CON")
 
 namespace ReadyTraderGo {
 
-// Theoretical maximum size of an (IPv4) UDP packet (actual maximum is lower).
-constexpr std::size_t READ_SIZE = 65535;
+// Pin the calling thread to the given CPU, logging any failure against the
+// named connection or subscription.
+static void pinThread(int cpu, const std::string& name)
+{
+#if defined(__linux__)
+    cpu_set_t cpus;
+    CPU_ZERO(&cpus);
+    CPU_SET(cpu, &cpus);
+    if (pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus) != 0)
+    {
+        RLOG(LG_CON, LogLevel::LL_WARNING) << std::quoted(name, '\'') << " failed to pin thread to cpu " << cpu;
+    }
+#else
+    RLOG(LG_CON, LogLevel::LL_WARNING) << std::quoted(name, '\'') << " thread pinning is not supported";
+#endif
+}
+
+bool StreamConnection::DeliverMessages(std::uint64_t receivedAt)
+{
+    while (mInBuffer.Size() >= MESSAGE_HEADER_SIZE)
+    {
+        const std::size_t messageLength = (std::size_t(mInBuffer.Peek(0)) << 8) | mInBuffer.Peek(1);
+        if (messageLength < MESSAGE_HEADER_SIZE)
+        {
+            RLOG(LG_CON, LogLevel::LL_ERROR) << std::quoted(mName, '\'') << " received message with invalid size="
+                                             << messageLength;
+            return false;
+        }
+        if (mInBuffer.Size() < messageLength)
+            break;
+
+        // Messages that wrap around the end of the ring are copied out.
+        auto const* upto = mInBuffer.Contiguous(0, messageLength);
+        if (upto == nullptr)
+        {
+            mInBuffer.CopyOut(0, mReceiveScratch.data(), messageLength);
+            upto = mReceiveScratch.data();
+        }
+
+        const unsigned char messageType = upto[MESSAGE_TYPE_OFFSET];
+        RLOG(LG_CON, LogLevel::LL_DEBUG) << std::quoted(mName, '\'')
+                                         << " received message with type=" << static_cast<int>(messageType)
+                                         << " and size=" << messageLength;
+        RTG_LATENCY_POINT(BeginMessage(LatencyRecorder::Source::EXECUTION, receivedAt));
+        OnMessageReceipt(messageType, upto + MESSAGE_HEADER_SIZE, messageLength - MESSAGE_HEADER_SIZE);
+        RTG_LATENCY_POINT(EndMessage());
+        mInBuffer.Consume(messageLength);
+    }
+    return true;
+}
 
 Connection::Connection(boost::asio::io_context& context, tcp::socket&& socket)
     : mContext(context),
-      mInBuffer(),
-      mOutBuffer(),
-      mSocket(std::move(socket))
+      mSocket(std::move(socket)),
+      mOutBuffer()
 {
     SetName('\'' + std::to_string(mSocket.local_endpoint().port()) + '\'');
 }
@@ -67,12 +127,20 @@ Connection::~Connection()
 
 void Connection::AsyncRead()
 {
-    auto buf = mInBuffer.prepare(READ_SIZE);
     mSocket.async_read_some(
-        buf,
+        mInBuffer.Prepare(),
         [this](auto& error, auto size) { ReadSomeHandler(error, size); });
 }
 
+void Connection::Flush()
+{
+    // Everything pending goes out in one write of (at most) two buffers.
+    if (!mIsSending && mOutBuffer.Size() > 0)
+    {
+        Send();
+    }
+}
+
 void Connection::ReadSomeHandler(const boost::system::error_code& error, std::size_t size)
 {
     if (error)
@@ -97,39 +165,63 @@ void Connection::ReadSomeHandler(const boost::system::error_code& error, std::si
         return;
     }
 
+    const std::uint64_t receivedAt = LatencyTimestamp();
     RLOG(LG_CON, LogLevel::LL_DEBUG) << std::quoted(mName, '\'') << " received " << size
                                      << " bytes";
-    mInBuffer.commit(size);
+    mInBuffer.Commit(size);
 
-    auto* const begin = (unsigned char const*) mInBuffer.data().data();
-    auto* upto = begin;
-    auto available = size;
-
-    while (available >= MESSAGE_HEADER_SIZE)
+    if (!DeliverMessages(receivedAt))
     {
-        const std::size_t messageLength = boost::endian::big_to_native(*(uint16_t*)upto);
-        if (available < messageLength)
-            break;
+        OnDisconnect();
+        return;
+    }
 
-        const unsigned char messageType = upto[MESSAGE_TYPE_OFFSET];
-        RLOG(LG_CON, LogLevel::LL_DEBUG) << std::quoted(mName, '\'')
-                                         << " received message with type=" << static_cast<int>(messageType)
-                                         << " and size=" << messageLength;
-        OnMessageReceipt(messageType, upto + MESSAGE_HEADER_SIZE, messageLength - MESSAGE_HEADER_SIZE);
+    AsyncRead();
+}
 
-        upto += messageLength;
-        available -= messageLength;
+BusyPollConnection::BusyPollConnection(boost::asio::io_context& context, tcp::socket&& socket, int busyPollTime)
+    : Connection(context, std::move(socket))
+{
+#if defined(SO_BUSY_POLL)
+    if (busyPollTime > 0
+        && setsockopt(mSocket.native_handle(), SOL_SOCKET, SO_BUSY_POLL, &busyPollTime, sizeof(busyPollTime)) != 0)
+    {
+        // Raising the busy poll time above net.core.busy_read needs
+        // CAP_NET_ADMIN; polling without it still avoids the reactor.
+        RLOG(LG_CON, LogLevel::LL_WARNING) << std::quoted(mName, '\'') << " failed to set SO_BUSY_POLL: "
+                                           << std::strerror(errno);
     }
+#else
+    RLOG(LG_CON, LogLevel::LL_WARNING) << std::quoted(mName, '\'') << " SO_BUSY_POLL is not supported";
+#endif
+}
 
-    mInBuffer.consume(upto - begin);
-    AsyncRead();
+void BusyPollConnection::AsyncRead()
+{
+    std::weak_ptr<bool> isAlive = mIsAlive;
+    boost::asio::post(mContext, [this, isAlive] {
+        if (isAlive.expired())
+        {
+            return;
+        }
+
+        boost::system::error_code error;
+        std::size_t size = mSocket.read_some(mInBuffer.Prepare(), error);
+        if (error == error::would_block)
+        {
+            AsyncRead();
+            return;
+        }
+        ReadSomeHandler(error, size);
+    });
 }
 
 void Connection::Send()
 {
     mIsSending = true;
-    mSocket.async_write_some(mOutBuffer.data(),
+    mSocket.async_write_some(mOutBuffer.Data(),
                              [this](auto& err, auto sz) { WriteSomeHandler(err, sz); });
+    RTG_LATENCY_POINT(SocketWritten());
 }
 
 void Connection::Send(SendMode mode)
@@ -137,8 +229,12 @@ void Connection::Send(SendMode mode)
     if (mode == SendMode::ASAP)
     {
         Send();
+        return;
     }
-    else if (!mIsSendPosted)
+
+    // Written once control returns to the io_context.
+    RTG_LATENCY_POINT(WriteDeferred());
+    if (!mIsSendPosted)
     {
         boost::asio::post(mContext, [this] {
             mIsSendPosted = false;
@@ -154,13 +250,58 @@ void Connection::Send(SendMode mode)
 void Connection::SendMessage(unsigned char messageType, const ISerialisable& serialisable, SendMode mode)
 {
     const std::size_t size = MESSAGE_HEADER_SIZE + serialisable.Size();
-    auto buf = mOutBuffer.prepare(size);
-    auto* data = static_cast<unsigned char*>(buf.data());
+    if (size > mOutBuffer.Free())
+    {
+        RLOG(LG_CON, LogLevel::LL_ERROR) << std::quoted(mName, '\'') << " send buffer full, "
+                                         << mOutBuffer.Size() << " bytes pending";
+        throw ReadyTraderGoError("send buffer full");
+    }
+
+    // Serialise in place unless the message would wrap around the ring.
+    auto* data = mOutBuffer.ContiguousSpace(size);
+    const bool isWrapped = data == nullptr;
+    if (isWrapped)
+    {
+        data = mSendScratch.data();
+    }
     *(uint16_t*)data = boost::endian::native_to_big((uint16_t)size);
     data[MESSAGE_TYPE_OFFSET] = messageType;
     serialisable.Serialise(data + MESSAGE_HEADER_SIZE);
-    mOutBuffer.commit(size);
-    if (!mIsSending)
+    if (isWrapped)
+    {
+        mOutBuffer.Write(data, size);
+    }
+    else
+    {
+        mOutBuffer.Commit(size);
+    }
+    if (mIsSending)
+    {
+        // Written by WriteSomeHandler once the write in progress completes.
+        RTG_LATENCY_POINT(WriteDeferred());
+    }
+    else if (mode != SendMode::DEFERRED)
+    {
+        Send(mode);
+    }
+}
+
+void Connection::SendEncoded(unsigned char const* data, std::size_t size, SendMode mode)
+{
+    if (size > mOutBuffer.Free())
+    {
+        RLOG(LG_CON, LogLevel::LL_ERROR) << std::quoted(mName, '\'') << " send buffer full, "
+                                         << mOutBuffer.Size() << " bytes pending";
+        throw ReadyTraderGoError("send buffer full");
+    }
+
+    mOutBuffer.Write(data, size);
+    if (mIsSending)
+    {
+        // Written by WriteSomeHandler once the write in progress completes.
+        RTG_LATENCY_POINT(WriteDeferred());
+    }
+    else if (mode != SendMode::DEFERRED)
     {
         Send(mode);
     }
@@ -183,13 +324,14 @@ void Connection::WriteSomeHandler(const boost::system::error_code& error, std::s
     {
         RLOG(LG_CON, LogLevel::LL_DEBUG) << std::quoted(mName, '\'') << " sent "
                                          << size << " bytes";
-        mOutBuffer.consume(size);
+        mOutBuffer.Consume(size);
     }
 
-    if (mOutBuffer.size() > 0)
+    if (mOutBuffer.Size() > 0)
     {
         mSocket.async_write_some(
-            mOutBuffer.data(), [this](auto& err, auto sz) { WriteSomeHandler(err, sz); });
+            mOutBuffer.Data(), [this](auto& err, auto sz) { WriteSomeHandler(err, sz); });
+        RTG_LATENCY_POINT(SocketWritten());
     }
     else
     {
@@ -197,8 +339,365 @@ void Connection::WriteSomeHandler(const boost::system::error_code& error, std::s
     }
 }
 
+static inline unsigned char frameFlag(unsigned char const* addr)
+{
+    return *(volatile unsigned char const*) addr;
+}
+
+FrameReader::Status FrameReader::Next(SubscriptionFrame& frame)
+{
+    auto const* addr = mBase + mPos;
+    if (frameFlag(addr) == 0)
+    {
+        return Status::EMPTY;
+    }
+    std::atomic_thread_fence(std::memory_order_acquire);
+
+    std::size_t payloadSize = boost::endian::big_to_native(*(uint32_t const*)(addr + FRAME_PAYLOAD_SIZE_OFFSET));
+    if (payloadSize > frame.mPayload.size())
+    {
+        payloadSize = frame.mPayload.size();
+    }
+    frame.mSize = payloadSize;
+    std::memcpy(frame.mPayload.data(), addr + FRAME_HEADER_SIZE, payloadSize);
+    std::atomic_thread_fence(std::memory_order_acquire);
+
+    // The writer clears a frame's flag before it starts overwriting it, so a
+    // cleared flag means the writer has caught up and the copy may be torn.
+    if (frameFlag(addr) == 0)
+    {
+        Resynchronise();
+        return Status::OVERRUN;
+    }
+    mPos = (mPos + FRAME_SIZE) & (SUBSCRIPTION_TRANSPORT_BUFFER_SIZE - 1);
+
+    constexpr std::size_t SEQUENCE_OFFSET = MESSAGE_HEADER_SIZE + MessageFieldSize::BYTE;
+    if (payloadSize < SEQUENCE_OFFSET + MessageFieldSize::LONG)
+    {
+        return Status::READY;
+    }
+
+    const unsigned char messageType = frame.mPayload[MESSAGE_TYPE_OFFSET];
+    const unsigned char instrument = frame.mPayload[MESSAGE_HEADER_SIZE];
+    if ((messageType != MessageType::ORDER_BOOK_UPDATE && messageType != MessageType::TRADE_TICKS)
+        || instrument > static_cast<unsigned char>(Instrument::ETF))
+    {
+        return Status::READY;
+    }
+
+    const unsigned long sequence = boost::endian::big_to_native(*(uint32_t const*)(frame.mPayload.data() + SEQUENCE_OFFSET));
+    const int stream = messageType == MessageType::TRADE_TICKS;
+    auto& last = mLastSequence[stream][instrument];
+    auto& isResynchronising = mIsResynchronising[stream][instrument];
+
+    if (last != 0 && sequence <= last)
+    {
+        if (isResynchronising)
+        {
+            return Status::SKIPPED;
+        }
+        // An old frame means the writer lapped us and we are now reading
+        // frames from its previous pass.
+        Resynchronise();
+        return Status::OVERRUN;
+    }
+
+    const bool isGap = last != 0 && sequence != last + 1 && !isResynchronising;
+    last = sequence;
+    isResynchronising = false;
+
+    if (isGap)
+    {
+        Resynchronise();
+        return Status::GAP;
+    }
+    return Status::READY;
+}
+
+void FrameReader::Resynchronise()
+{
+    // The writer clears the flag of the frame after the one it writes, so
+    // the newest frame is the one preceding the only cleared frame whose
+    // predecessor is set. If nothing has been published yet, stay put.
+    for (std::size_t i = 0; i < SUBSCRIPTION_TRANSPORT_FRAME_COUNT; ++i)
+    {
+        const unsigned long pos = i * FRAME_SIZE;
+        const unsigned long previous = (pos - FRAME_SIZE) & (SUBSCRIPTION_TRANSPORT_BUFFER_SIZE - 1);
+        if (frameFlag(mBase + pos) == 0 && frameFlag(mBase + previous) != 0)
+        {
+            mPos = previous;
+            break;
+        }
+    }
+
+    for (auto& stream : mIsResynchronising)
+    {
+        stream[0] = stream[1] = true;
+    }
+}
+
+PipelinedConnection::PipelinedConnection(boost::asio::io_context& context, int cpu)
+    : mContext(context),
+      mIoContext(1),
+      mContextWork(boost::asio::make_work_guard(mContext)),
+      mIoContextWork(boost::asio::make_work_guard(mIoContext)),
+      mCpu(cpu)
+{
+}
+
+PipelinedConnection::~PipelinedConnection()
+{
+    mContextWork.reset();
+    mIsStopping = true;
+    if (mThread.joinable())
+    {
+        mThread.join();
+    }
+}
+
+void PipelinedConnection::SetConnection(std::unique_ptr<IConnection>&& connection)
+{
+    mConnection = std::move(connection);
+    mConnection->MessageReceived = [this](IConnection*,
+                                          unsigned char t,
+                                          unsigned char const* d,
+                                          std::size_t s) { Receive(t, d, s); };
+    mConnection->Disconnected = [this] {
+        // Posted after any drain of the messages received before it.
+        std::weak_ptr<bool> isAlive = mIsAlive;
+        boost::asio::post(mContext, [this, isAlive] {
+            if (!isAlive.expired())
+            {
+                DrainInbound();
+                mContextWork.reset();
+                OnDisconnect();
+            }
+        });
+    };
+}
+
+void PipelinedConnection::AsyncRead()
+{
+    mConnection->SetName(mName);
+    mThread = std::thread([this] { Run(); });
+}
+
+PipelineMessage& PipelinedConnection::ClaimOutbound(std::size_t size)
+{
+    if (size > PIPELINE_MESSAGE_SIZE)
+    {
+        RLOG(LG_CON, LogLevel::LL_ERROR) << std::quoted(mName, '\'') << " message of " << size
+                                         << " bytes is too large for the pipeline";
+        throw ReadyTraderGoError("message too large for the pipeline");
+    }
+
+    PipelineMessage* message;
+    while ((message = mOutbound.Claim()) == nullptr)
+    {
+        // A failed pipeline thread will never make room.
+        if (mHasFailed.load(std::memory_order_acquire))
+        {
+            std::rethrow_exception(mError);
+        }
+        cpuRelax();
+    }
+    return *message;
+}
+
+void PipelinedConnection::Flush()
+{
+    if (mHasDeferred)
+    {
+        PipelineMessage& message = ClaimOutbound(0);
+        message.mSize = 0;
+        mOutbound.Push();
+        mHasDeferred = false;
+    }
+}
+
+void PipelinedConnection::SendEncoded(unsigned char const* data, std::size_t size, SendMode mode)
+{
+    PipelineMessage& message = ClaimOutbound(size);
+    std::memcpy(message.mData.data(), data, size);
+    PushOutbound(message, size, mode);
+}
+
+void PipelinedConnection::SendMessage(unsigned char messageType, const ISerialisable& serialisable, SendMode mode)
+{
+    const std::size_t size = MESSAGE_HEADER_SIZE + serialisable.Size();
+    PipelineMessage& message = ClaimOutbound(size);
+    unsigned char* data = message.mData.data();
+    *(uint16_t*)data = boost::endian::native_to_big((uint16_t)size);
+    data[MESSAGE_TYPE_OFFSET] = messageType;
+    serialisable.Serialise(data + MESSAGE_HEADER_SIZE);
+    PushOutbound(message, size, mode);
+}
+
+void PipelinedConnection::DrainInbound()
+{
+    // Clear the flag before draining so that any message pushed after the
+    // queue is found empty causes another drain to be posted.
+    mIsDrainPosted = false;
+    if constexpr (LATENCY_STATS_ENABLED)
+    {
+        while (auto* trace = mWritten.Front())
+        {
+            GetLatencyRecorder().RecordWrite(*trace);
+            mWritten.Pop();
+        }
+    }
+    while (auto* message = mInbound.Front())
+    {
+        RTG_LATENCY_POINT(BeginMessage(LatencyRecorder::Source::EXECUTION, message->mReceivedAt));
+        OnMessageReceipt(message->mData[MESSAGE_TYPE_OFFSET],
+                         message->mData.data() + MESSAGE_HEADER_SIZE,
+                         message->mSize - MESSAGE_HEADER_SIZE);
+        RTG_LATENCY_POINT(EndMessage());
+        mInbound.Pop();
+    }
+}
+
+bool PipelinedConnection::DrainOutbound()
+{
+    bool isDrained = false;
+    while (auto* message = mOutbound.Front())
+    {
+        if (message->mSize == 0)
+        {
+            mConnection->Flush();
+        }
+        else
+        {
+            if constexpr (LATENCY_STATS_ENABLED)
+            {
+                if (message->mTrace.mSeenAt != 0)
+                {
+                    GetLatencyRecorder().RelayWrite(message->mTrace);
+                }
+            }
+            mConnection->SendEncoded(message->mData.data(), message->mSize, message->mMode);
+        }
+        mOutbound.Pop();
+        isDrained = true;
+    }
+    return isDrained;
+}
+
+void PipelinedConnection::PostDrainInbound()
+{
+    if (!mIsDrainPosted.exchange(true))
+    {
+        std::weak_ptr<bool> isAlive = mIsAlive;
+        boost::asio::post(mContext, [this, isAlive] {
+            if (!isAlive.expired())
+            {
+                DrainInbound();
+            }
+        });
+    }
+}
+
+void PipelinedConnection::PushOutbound(PipelineMessage& message, std::size_t size, SendMode mode)
+{
+    if constexpr (LATENCY_STATS_ENABLED)
+    {
+        message.mTrace = LatencyRecorder::Trace{};
+        GetLatencyRecorder().HandOffWrite(message.mTrace);
+    }
+    message.mSize = size;
+    message.mMode = mode;
+    mOutbound.Push();
+    mHasDeferred |= mode == SendMode::DEFERRED;
+}
+
+void PipelinedConnection::Receive(unsigned char messageType, unsigned char const* data, std::size_t size)
+{
+    const std::size_t encodedSize = MESSAGE_HEADER_SIZE + size;
+    if (encodedSize > PIPELINE_MESSAGE_SIZE)
+    {
+        RLOG(LG_CON, LogLevel::LL_ERROR) << std::quoted(mName, '\'') << " received message of " << encodedSize
+                                         << " bytes, which is too large for the pipeline";
+        return;
+    }
+
+    PipelineMessage* message;
+    while ((message = mInbound.Claim()) == nullptr)
+    {
+        // The strategy thread may itself be waiting for room to send.
+        PostDrainInbound();
+        DrainOutbound();
+        cpuRelax();
+    }
+    // The inner connection began tracing the message when it read it.
+    message->mReceivedAt = LATENCY_STATS_ENABLED ? GetLatencyRecorder().GetSeenAt() : 0;
+    message->mSize = encodedSize;
+    message->mData[MESSAGE_TYPE_OFFSET] = messageType;
+    std::memcpy(message->mData.data() + MESSAGE_HEADER_SIZE, data, size);
+    mInbound.Push();
+    PostDrainInbound();
+}
+
+void PipelinedConnection::ReturnWrittenTrace()
+{
+    // A trace that does not fit is dropped rather than wait for room.
+    LatencyRecorder::Trace trace;
+    if (GetLatencyRecorder().TakeRelayed(trace) && mWritten.TryPush(trace))
+    {
+        PostDrainInbound();
+    }
+}
+
+void PipelinedConnection::Run()
+{
+    if (mCpu >= 0)
+    {
+        pinThread(mCpu, mName);
+    }
+
+    RLOG(LG_CON, LogLevel::LL_INFO) << std::quoted(mName, '\'') << " pipeline thread running on cpu " << mCpu;
+
+    try
+    {
+        mConnection->AsyncRead();
+        while (!mIsStopping.load(std::memory_order_relaxed))
+        {
+            // One handler at a time, as transports that poll their socket
+            // re-post a handler whenever they run one.
+            bool isBusy = DrainOutbound();
+            isBusy |= mIoContext.poll_one() > 0;
+            if constexpr (LATENCY_STATS_ENABLED)
+            {
+                ReturnWrittenTrace();
+            }
+            if (!isBusy)
+            {
+                cpuRelax();
+            }
+        }
+    }
+    catch (...)
+    {
+        RLOG(LG_CON, LogLevel::LL_ERROR) << std::quoted(mName, '\'') << " pipeline thread stopped by an exception";
+        mError = std::current_exception();
+        mHasFailed.store(true, std::memory_order_release);
+
+        // Rethrow it where it would have been thrown without the pipeline.
+        std::weak_ptr<bool> isAlive = mIsAlive;
+        boost::asio::post(mContext, [this, isAlive] {
+            if (!isAlive.expired())
+            {
+                mContextWork.reset();
+                std::rethrow_exception(mError);
+            }
+        });
+    }
+}
+
 Subscription::Subscription(boost::asio::io_context& context, interprocess::file_mapping& file, interprocess::mapped_region& region)
-    : mContext(context), mFile(std::move(file)), mRegion(std::move(region))
+    : mContext(context),
+      mFile(std::move(file)),
+      mRegion(std::move(region)),
+      mReader((unsigned char const*) mRegion.get_address())
 {
     SetName(std::string(mFile.get_name()));
 }
@@ -211,10 +710,11 @@ Subscription::~Subscription()
 void Subscription::AsyncReceive()
 {
     std::weak_ptr<ISubscription> weak_this = shared_from_this();
-    mContext.post([this, weak_this](){ AsyncReceive(0, weak_this); });
+    mReader.Resynchronise();
+    mContext.post([this, weak_this](){ AsyncReceive(weak_this); });
 }
 
-void Subscription::AsyncReceive(unsigned long pos, std::weak_ptr<ISubscription> weak_this)
+void Subscription::AsyncReceive(std::weak_ptr<ISubscription> weak_this)
 {
     if (weak_this.expired())
     {
@@ -222,17 +722,35 @@ void Subscription::AsyncReceive(unsigned long pos, std::weak_ptr<ISubscription>
         return;
     }
 
-    unsigned char* addr = ((unsigned char*)mRegion.get_address()) + pos;
-
-    if (addr[0] != 0)
+    if (ReadFrame(mFrame))
     {
-        const uint32_t* payload_size_ptr = (uint32_t*)(addr + FRAME_PAYLOAD_SIZE_OFFSET);
-        const std::size_t payloadSize = boost::endian::big_to_native(*payload_size_ptr);
-        ReceiveFromHandler(addr + FRAME_HEADER_SIZE, payloadSize);
-        pos = (pos + FRAME_SIZE) & (SUBSCRIPTION_TRANSPORT_BUFFER_SIZE - 1);
+        RTG_LATENCY_POINT(BeginMessage(LatencyRecorder::Source::INFORMATION, mFrame.mDetectedAt));
+        ReceiveFromHandler(mFrame.mPayload.data(), mFrame.mSize);
+        RTG_LATENCY_POINT(EndMessage());
     }
 
-    mContext.post([this, pos, weak_this](){ AsyncReceive(pos, weak_this); });
+    mContext.post([this, weak_this](){ AsyncReceive(weak_this); });
+}
+
+bool Subscription::ReadFrame(SubscriptionFrame& frame)
+{
+    switch (mReader.Next(frame))
+    {
+    case FrameReader::Status::READY:
+        frame.mDetectedAt = LatencyTimestamp();
+        return true;
+    case FrameReader::Status::GAP:
+        frame.mDetectedAt = LatencyTimestamp();
+        RLOG(LG_CON, LogLevel::LL_WARNING) << std::quoted(mName, '\'') << " sequence gap detected, skipped to newest frame"
+                                           << " (gaps=" << ++mGapCount << ")";
+        return true;
+    case FrameReader::Status::OVERRUN:
+        RLOG(LG_CON, LogLevel::LL_WARNING) << std::quoted(mName, '\'') << " transport overrun detected, skipped to newest frame"
+                                           << " (overruns=" << ++mOverrunCount << ")";
+        return false;
+    default:
+        return false;
+    }
 }
 
 void Subscription::ReceiveFromHandler(unsigned char const* data, std::size_t size)
@@ -257,11 +775,99 @@ void Subscription::ReceiveFromHandler(unsigned char const* data, std::size_t siz
     OnMessageReceipt(messageType, data + MESSAGE_HEADER_SIZE, messageLength - MESSAGE_HEADER_SIZE);
 }
 
+SpinningSubscription::SpinningSubscription(boost::asio::io_context& context,
+                                           interprocess::file_mapping& file,
+                                           interprocess::mapped_region& region,
+                                           int cpu)
+    : Subscription(context, file, region), mCpu(cpu)
+{
+}
+
+SpinningSubscription::~SpinningSubscription()
+{
+    mIsStopping = true;
+    if (mThread.joinable())
+    {
+        mThread.join();
+    }
+}
+
+void SpinningSubscription::AsyncReceive()
+{
+    std::weak_ptr<ISubscription> weak_this = shared_from_this();
+    mThread = std::thread([this, weak_this] { Spin(weak_this); });
+}
+
+void SpinningSubscription::Drain()
+{
+    // Clear the flag before draining so that any frame pushed after the
+    // queue is found empty causes another drain to be posted.
+    mIsDrainPosted = false;
+    while (auto* frame = mQueue.Front())
+    {
+        RTG_LATENCY_POINT(BeginMessage(LatencyRecorder::Source::INFORMATION, frame->mDetectedAt));
+        ReceiveFromHandler(frame->mPayload.data(), frame->mSize);
+        RTG_LATENCY_POINT(EndMessage());
+        mQueue.Pop();
+    }
+}
+
+void SpinningSubscription::Spin(std::weak_ptr<ISubscription> weak_this)
+{
+    if (mCpu >= 0)
+    {
+        pinThread(mCpu, mName);
+    }
+
+    RLOG(LG_CON, LogLevel::LL_INFO) << std::quoted(mName, '\'') << " spinning on cpu " << mCpu;
+
+    mReader.Resynchronise();
+
+    while (!mIsStopping.load(std::memory_order_relaxed))
+    {
+        SubscriptionFrame* frame;
+        while ((frame = mQueue.Claim()) == nullptr)
+        {
+            if (mIsStopping.load(std::memory_order_relaxed))
+                return;
+            cpuRelax();
+        }
+
+        if (!ReadFrame(*frame))
+        {
+            cpuRelax();
+            continue;
+        }
+        mQueue.Push();
+
+        if (!mIsDrainPosted.exchange(true))
+        {
+            boost::asio::post(mContext, [this, weak_this] {
+                if (!weak_this.expired())
+                {
+                    Drain();
+                }
+            });
+        }
+    }
+}
+
 ConnectionFactory::ConnectionFactory(boost::asio::io_context& context,
                                      std::string host,
-                                     unsigned short port)
-    : mContext(context), mHost(std::move(host)), mPort(port)
+                                     unsigned short port,
+                                     ExecutionOptions options)
+    : mContext(context), mHost(std::move(host)), mPort(port), mOptions(std::move(options))
 {
+    if (mOptions.mTransport != "asio" && mOptions.mTransport != "busypoll" && mOptions.mTransport != "io_uring")
+    {
+        throw ReadyTraderGoError("unknown execution transport '" + mOptions.mTransport
+                                 + "': expected 'asio', 'busypoll' or 'io_uring'");
+    }
+    if (mOptions.mTransport == "io_uring" && !IsUringAvailable())
+    {
+        throw ReadyTraderGoError("execution transport 'io_uring' is not available in this build");
+    }
+
     boost::system::error_code error;
     tcp::resolver resolver(mContext);
     auto endpoints = resolver.resolve(mHost, std::to_string(mPort), error);
@@ -285,9 +891,27 @@ static std::basic_ostream<C, T>& operator<<(std::basic_ostream<C, T>& strm, cons
 }
 
 std::unique_ptr<IConnection> ConnectionFactory::Create()
+{
+    if (!mOptions.mIsPipelined)
+    {
+        return Create(mContext);
+    }
+
+    // The calling thread runs the io_context on which the strategy runs and
+    // the pipeline thread services the socket.
+    if (mOptions.mCpu >= 0)
+    {
+        pinThread(mOptions.mCpu, "Exec");
+    }
+    auto pipeline = std::make_unique<PipelinedConnection>(mContext, mOptions.mPipelineCpu);
+    pipeline->SetConnection(Create(pipeline->GetIoContext()));
+    return pipeline;
+}
+
+std::unique_ptr<IConnection> ConnectionFactory::Create(boost::asio::io_context& context)
 {
     boost::system::error_code error;
-    tcp::socket sock(mContext);
+    tcp::socket sock(context);
 
     RLOG(LG_CON, LogLevel::LL_INFO) << "connecting to: " << mEndpoints[0];
     boost::asio::connect(sock, mEndpoints, error);
@@ -305,20 +929,44 @@ std::unique_ptr<IConnection> ConnectionFactory::Create()
     // It's not the end of the world if this fails, so any error is ignored.
     sock.set_option(tcp::no_delay(true), error);
 
-    return std::make_unique<Connection>(mContext, std::move(sock));
+    if (mOptions.mTransport == "busypoll")
+    {
+        // The connection is created on the thread that runs the io_context,
+        // which from now on never sleeps.
+        if (mOptions.mCpu >= 0 && !mOptions.mIsPipelined)
+        {
+            pinThread(mOptions.mCpu, "Exec");
+        }
+        return std::make_unique<BusyPollConnection>(context, std::move(sock), mOptions.mBusyPollTime);
+    }
+    if (mOptions.mTransport == "io_uring")
+    {
+        return std::make_unique<UringConnection>(context, sock.release(), mOptions.mIsSqPoll, mOptions.mSqPollCpu);
+    }
+    return std::make_unique<Connection>(context, std::move(sock));
 }
 
 SubscriptionFactory::SubscriptionFactory(boost::asio::io_context& context,
                                          const std::string& type,
-                                         const std::string& name)
-    : mContext(context), mType(type), mName(name)
+                                         const std::string& name,
+                                         const std::string& mode,
+                                         int cpu)
+    : mContext(context), mType(type), mName(name), mMode(mode), mCpu(cpu)
 {
+    if (mMode != "poll" && mMode != "spin")
+    {
+        throw ReadyTraderGoError("unknown information mode '" + mMode + "': expected 'poll' or 'spin'");
+    }
 }
 
 std::shared_ptr<ISubscription> SubscriptionFactory::Create()
 {
     interprocess::file_mapping file{mName.c_str(), interprocess::read_only};
     interprocess::mapped_region region{file, interprocess::read_only};
+    if (mMode == "spin")
+    {
+        return std::make_shared<SpinningSubscription>(mContext, file, region, mCpu);
+    }
     return std::make_shared<Subscription>(mContext, file, region);
 }
 
@@ -18,30 +18,38 @@
 #ifndef CPPREADY_TRADER_GO_LIBS_READY_TRADER_GO_CONNECTIVITY_H
 #define CPPREADY_TRADER_GO_LIBS_READY_TRADER_GO_CONNECTIVITY_H
 
+#include <array>
+#include <atomic>
 #include <cstddef>
+#include <cstdint>
+#include <exception>
 #include <memory>
 #include <string>
+#include <thread>
 #include <vector>
 
+#include <boost/asio/executor_work_guard.hpp>
 #include <boost/asio/io_context.hpp>
 #include <boost/asio/ip/tcp.hpp>
-#include <boost/asio/streambuf.hpp>
 #include <boost/interprocess/file_mapping.hpp>
 #include <boost/interprocess/mapped_region.hpp>
 #include <boost/system/error_code.hpp>
 
+#include "bytering.h"
 #include "connectivitytypes.h"
+#include "latency.h"
+#include "spscqueue.h"
 
 namespace interprocess = boost::interprocess;
 using boost::asio::ip::tcp;
 
 namespace ReadyTraderGo {
 
-// Each message begins with a two-part header:
-//   1. length - a two-byte, big endian, unsigned integer; and
-//   2. type - a one-byte unsigned integer.
-constexpr std::size_t MESSAGE_HEADER_SIZE = 3;
-constexpr std::size_t MESSAGE_TYPE_OFFSET = 2;
+constexpr std::size_t MAXIMUM_MESSAGE_SIZE = 65535;
+
+// Size of each of the execution connection's receive and send rings. Large
+// enough to hold any single message.
+constexpr std::size_t CONNECTION_BUFFER_SIZE = 65536;
 
 // Each subscription transport frame begins with a two-part header:
 //    1. spinlock - a four-byte little-endian flag (either 0 or 1); and
@@ -49,30 +57,194 @@ constexpr std::size_t MESSAGE_TYPE_OFFSET = 2;
 constexpr std::size_t FRAME_PAYLOAD_SIZE_OFFSET = 4;
 constexpr std::size_t FRAME_HEADER_SIZE = 8;
 constexpr std::size_t FRAME_SIZE = 128;
-constexpr std::size_t SUBSCRIPTION_TRANSPORT_BUFFER_SIZE = 8182;
+constexpr std::size_t SUBSCRIPTION_TRANSPORT_BUFFER_SIZE = 8192;
+constexpr std::size_t SUBSCRIPTION_TRANSPORT_FRAME_COUNT = SUBSCRIPTION_TRANSPORT_BUFFER_SIZE / FRAME_SIZE;
+
+// Number of frames the spinning subscription thread may hand over to the
+// io_context thread before it has to wait.
+constexpr std::size_t SPIN_QUEUE_CAPACITY = 256;
+
+// Number of messages each direction of a pipelined connection may hold and
+// the largest encoded message, header included, that it can carry.
+constexpr std::size_t PIPELINE_QUEUE_CAPACITY = 256;
+constexpr std::size_t PIPELINE_MESSAGE_SIZE = 112;
+
+// An encoded execution message passed between the strategy thread and a
+// pipelined connection's thread. A message with no size asks for the
+// messages sent before it to be flushed. A request carries the latency trace
+// of the message that caused it, if it is that message's first write.
+struct PipelineMessage
+{
+    std::uint64_t mReceivedAt = 0;
+    LatencyRecorder::Trace mTrace;
+    std::size_t mSize = 0;
+    SendMode mMode = SendMode::ASAP;
+    std::array<unsigned char, PIPELINE_MESSAGE_SIZE> mData;
+};
 
+// A copy of one subscription transport frame's payload.
+struct SubscriptionFrame
+{
+    std::uint64_t mDetectedAt = 0;
+    std::size_t mSize = 0;
+    std::array<unsigned char, FRAME_SIZE - FRAME_HEADER_SIZE> mPayload;
+};
 
-class Connection : public IConnection
+// Reads frames from the subscription transport ring in order, checking that
+// the writer has not lapped the reader and that information messages arrive
+// with consecutive sequence numbers. On a gap or overrun the reader skips
+// the backlog and resumes at the newest frame.
+class FrameReader
+{
+public:
+    enum class Status
+    {
+        EMPTY,    // no new frame is available
+        READY,    // a frame was copied out and should be delivered
+        SKIPPED,  // a frame already seen before a resynchronisation was skipped
+        GAP,      // a frame was copied out after a sequence gap; the reader
+                  // resynchronised but the frame should still be delivered
+        OVERRUN   // the writer lapped the reader, which resynchronised
+    };
+
+    explicit FrameReader(unsigned char const* base) : mBase(base) {}
+
+    Status Next(SubscriptionFrame& frame);
+    void Resynchronise();
+
+private:
+    unsigned char const* mBase;
+    unsigned long mPos = 0;
+    // Last sequence number seen for each (message type, instrument) pair and
+    // whether that stream may jump because the reader has resynchronised.
+    unsigned long mLastSequence[2][2] = {};
+    bool mIsResynchronising[2][2] = {{true, true}, {true, true}};
+};
+
+// A connection that receives a stream of bytes, which it splits into
+// messages and delivers.
+class StreamConnection : public IConnection
+{
+protected:
+    // Deliver every complete message in the receive ring. Returns false if a
+    // malformed message was received, after which the connection should be
+    // closed.
+    bool DeliverMessages(std::uint64_t receivedAt);
+
+    ByteRing<CONNECTION_BUFFER_SIZE> mInBuffer;
+    // Staging area for received messages that wrap around the end of the
+    // ring, which must outlive the message handler.
+    std::array<unsigned char, MAXIMUM_MESSAGE_SIZE> mReceiveScratch;
+};
+
+class Connection : public StreamConnection
 {
 public:
     Connection(boost::asio::io_context& context, tcp::socket&& socket);
     ~Connection() override;
     void AsyncRead() override;
+    void Flush() override;
+    void SendEncoded(unsigned char const* data, std::size_t size, SendMode mode) override;
     void SendMessage(unsigned char messageType, const ISerialisable& serialisable, SendMode mode) override;
 
+protected:
+    void ReadSomeHandler(const boost::system::error_code& error, std::size_t size);
+
+    boost::asio::io_context& mContext;
+    tcp::socket mSocket;
+
 private:
     void Send();
     void Send(SendMode mode);
 
-    void ReadSomeHandler(const boost::system::error_code& error, std::size_t size);
     void WriteSomeHandler(const boost::system::error_code& error, std::size_t size);
 
-    boost::asio::io_context& mContext;
-    boost::asio::streambuf mInBuffer;
-    boost::asio::streambuf mOutBuffer;
+    ByteRing<CONNECTION_BUFFER_SIZE> mOutBuffer;
+    // Staging area for sent messages that wrap around the end of the ring,
+    // kept apart from mReceiveScratch as handlers send while it is in use.
+    std::array<unsigned char, MAXIMUM_MESSAGE_SIZE> mSendScratch;
     bool mIsSending = false;
     bool mIsSendPosted = false;
-    tcp::socket mSocket;
+};
+
+// A connection that reads from its non-blocking socket in a handler that
+// re-posts itself to the io_context, in the same way as the information
+// subscription's poll mode, rather than waiting for the reactor to report
+// that data has arrived. Together with a polling subscription, the
+// io_context then services both from one loop that never sleeps in epoll.
+// Where SO_BUSY_POLL is available, each read also polls the network
+// device's receive queue for up to busyPollTime microseconds.
+class BusyPollConnection : public Connection
+{
+public:
+    BusyPollConnection(boost::asio::io_context& context, tcp::socket&& socket, int busyPollTime);
+    void AsyncRead() override;
+
+private:
+    // Expires when the connection is destroyed so posted reads can tell.
+    std::shared_ptr<bool> mIsAlive = std::make_shared<bool>(true);
+};
+
+// A connection that services its socket from a dedicated thread, optionally
+// pinned to a CPU, so that a slow socket does not hold up the io_context
+// thread on which the strategy and information subscription run.
+//
+// The inner connection is created on the pipelined connection's own
+// io_context, which the dedicated thread polls without sleeping. Requests
+// are encoded on the strategy thread and handed over through one
+// single-producer, single-consumer queue; received messages come back
+// through another and are delivered on the io_context thread, so message
+// handlers run on the same thread as before. Socket writes are timed on the
+// dedicated thread and the times passed back, so that every stage is still
+// recorded by the io_context thread's latency recorder. Deferred requests
+// are still written together when the connection is flushed. An exception
+// thrown on the dedicated thread stops it and is rethrown on the io_context
+// thread.
+class PipelinedConnection : public IConnection
+{
+public:
+    PipelinedConnection(boost::asio::io_context& context, int cpu);
+    ~PipelinedConnection() override;
+
+    // The io_context on which the inner connection must be created.
+    boost::asio::io_context& GetIoContext() noexcept { return mIoContext; }
+    void SetConnection(std::unique_ptr<IConnection>&& connection);
+
+    void AsyncRead() override;
+    void Flush() override;
+    void SendEncoded(unsigned char const* data, std::size_t size, SendMode mode) override;
+    void SendMessage(unsigned char messageType, const ISerialisable& serialisable, SendMode mode) override;
+
+private:
+    PipelineMessage& ClaimOutbound(std::size_t size);
+    void DrainInbound();
+    bool DrainOutbound();
+    void PostDrainInbound();
+    void PushOutbound(PipelineMessage& message, std::size_t size, SendMode mode);
+    void Receive(unsigned char messageType, unsigned char const* data, std::size_t size);
+    void ReturnWrittenTrace();
+    void Run();
+
+    boost::asio::io_context& mContext;
+    boost::asio::io_context mIoContext;
+    // Keep each io_context running while the connection is open, as an
+    // outstanding read would.
+    boost::asio::executor_work_guard<boost::asio::io_context::executor_type> mContextWork;
+    boost::asio::executor_work_guard<boost::asio::io_context::executor_type> mIoContextWork;
+    std::unique_ptr<IConnection> mConnection;
+    int mCpu;
+    bool mHasDeferred = false;
+    std::atomic<bool> mIsDrainPosted{false};
+    std::atomic<bool> mIsStopping{false};
+    // Set once the dedicated thread has stopped because of mError.
+    std::atomic<bool> mHasFailed{false};
+    std::exception_ptr mError;
+    SpscQueue<PipelineMessage, PIPELINE_QUEUE_CAPACITY> mInbound;
+    SpscQueue<PipelineMessage, PIPELINE_QUEUE_CAPACITY> mOutbound;
+    SpscQueue<LatencyRecorder::Trace, PIPELINE_QUEUE_CAPACITY> mWritten;
+    // Expires when the connection is destroyed so posted drains can tell.
+    std::shared_ptr<bool> mIsAlive = std::make_shared<bool>(true);
+    std::thread mThread;
 };
 
 class Subscription : public ISubscription
@@ -84,13 +256,45 @@ public:
     ~Subscription() override;
     void AsyncReceive() override;
 
-private:
-    void AsyncReceive(unsigned long, std::weak_ptr<ISubscription>);
+protected:
+    bool ReadFrame(SubscriptionFrame& frame);
     void ReceiveFromHandler(unsigned char const*, std::size_t size);
 
     boost::asio::io_context& mContext;
     interprocess::file_mapping mFile;
     interprocess::mapped_region mRegion;
+    FrameReader mReader;
+
+private:
+    void AsyncReceive(std::weak_ptr<ISubscription>);
+
+    SubscriptionFrame mFrame;
+};
+
+// A subscription that polls the memory mapped file from a dedicated thread,
+// optionally pinned to a CPU, rather than by re-posting to the io_context.
+// Frames are copied into a single-producer, single-consumer queue and
+// delivered on the io_context thread, so message handlers still run on the
+// same thread as the execution connection.
+class SpinningSubscription : public Subscription
+{
+public:
+    SpinningSubscription(boost::asio::io_context& context,
+                         interprocess::file_mapping& file,
+                         interprocess::mapped_region& region,
+                         int cpu);
+    ~SpinningSubscription() override;
+    void AsyncReceive() override;
+
+private:
+    void Drain();
+    void Spin(std::weak_ptr<ISubscription> weak_this);
+
+    int mCpu;
+    std::atomic<bool> mIsDrainPosted{false};
+    std::atomic<bool> mIsStopping{false};
+    SpscQueue<SubscriptionFrame, SPIN_QUEUE_CAPACITY> mQueue;
+    std::thread mThread;
 };
 
 class ConnectionFactory : public IConnectionFactory
@@ -98,15 +302,19 @@ class ConnectionFactory : public IConnectionFactory
 public:
     ConnectionFactory(boost::asio::io_context& context,
                       std::string host,
-                      unsigned short port);
+                      unsigned short port,
+                      ExecutionOptions options = ExecutionOptions{});
 
     std::unique_ptr<IConnection> Create() override;
 
 private:
+    std::unique_ptr<IConnection> Create(boost::asio::io_context& context);
+
     boost::asio::io_context& mContext;
     std::vector<tcp::endpoint> mEndpoints;
     std::string mHost;
     unsigned short mPort;
+    ExecutionOptions mOptions;
 };
 
 class SubscriptionFactory : public ISubscriptionFactory
@@ -114,7 +322,9 @@ class SubscriptionFactory : public ISubscriptionFactory
 public:
     SubscriptionFactory(boost::asio::io_context& context,
                         const std::string& type,
-                        const std::string& name);
+                        const std::string& name,
+                        const std::string& mode = "poll",
+                        int cpu = -1);
 
     std::shared_ptr<ISubscription> Create() override;
 
@@ -122,6 +332,8 @@ private:
     boost::asio::io_context& mContext;
     std::string mType;
     std::string mName;
+    std::string mMode;
+    int mCpu;
 };
 
 }
@@ -18,17 +18,26 @@
 #ifndef CPPREADY_TRADER_GO_LIBS_READY_TRADER_GO_CONNECTIVITYTYPES_H
 #define CPPREADY_TRADER_GO_LIBS_READY_TRADER_GO_CONNECTIVITYTYPES_H
 
+#include <atomic>
 #include <cstddef>
 #include <functional>
 #include <memory>
+#include <string>
 #include <utility>
 
 namespace ReadyTraderGo {
 
+// Each message begins with a two-part header:
+//   1. length - a two-byte, big endian, unsigned integer; and
+//   2. type - a one-byte unsigned integer.
+constexpr std::size_t MESSAGE_HEADER_SIZE = 3;
+constexpr std::size_t MESSAGE_TYPE_OFFSET = 2;
+
 enum class SendMode
 {
-    ASAP,
-    SOON
+    ASAP,     // start writing immediately
+    SOON,     // write once control returns to the io_context
+    DEFERRED  // write when the connection is next flushed
 };
 
 struct ISerialisable
@@ -49,6 +58,11 @@ struct IConnection
     {
         SendMessage(messageType, serialisable, SendMode::ASAP);
     }
+    // Send a message that is already encoded, header included.
+    virtual void SendEncoded(unsigned char const* data, std::size_t size, SendMode mode) = 0;
+
+    // Start writing any messages sent with SendMode::DEFERRED.
+    virtual void Flush() = 0;
 
     const std::string& GetName() const { return mName; }
     void SetName(std::string name) { mName = std::move(name); }
@@ -84,6 +98,10 @@ struct ISubscription: public std::enable_shared_from_this<ISubscription>
     const std::string& GetName() const { return mName; }
     void SetName(std::string name) { mName = std::move(name); }
 
+    // Number of sequence gaps and transport overruns detected so far.
+    unsigned long GetGapCount() const { return mGapCount.load(std::memory_order_relaxed); }
+    unsigned long GetOverrunCount() const { return mOverrunCount.load(std::memory_order_relaxed); }
+
     std::function<void(ISubscription*, unsigned char, unsigned char const*, std::size_t)> MessageReceived;
 
 protected:
@@ -96,6 +114,21 @@ protected:
     }
 
     std::string mName;
+    std::atomic<unsigned long> mGapCount{0};
+    std::atomic<unsigned long> mOverrunCount{0};
+};
+
+// How the execution connection talks to the exchange; see the Execution
+// section of the autotrader configuration.
+struct ExecutionOptions
+{
+    std::string mTransport = "asio";
+    bool mIsSqPoll = false;
+    int mSqPollCpu = -1;
+    int mBusyPollTime = 50;
+    int mCpu = -1;
+    bool mIsPipelined = false;
+    int mPipelineCpu = -1;
 };
 
 struct IConnectionFactory
@@ -0,0 +1,233 @@
+// Copyright 2021 Optiver Asia Pacific Pty. Ltd.
+//
+// This file is part of Ready Trader Go.
+//
+//     Ready Trader Go is free software: you can redistribute it and/or
+//     modify it under the terms of the GNU Affero General Public License
+//     as published by the Free Software Foundation, either version 3 of
+//     the License, or (at your option) any later version.
+//
+//     Ready Trader Go is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU Affero General Public License for more details.
+//
+//     You should have received a copy of the GNU Affero General Public
+//     License along with Ready Trader Go.  If not, see
+//     <https://www.gnu.org/licenses/>.
+#include <cstring>
+#include <map>
+#include <ostream>
+
+#include <boost/date_time/c_local_time_adjustor.hpp>
+#include <boost/date_time/posix_time/posix_time_types.hpp>
+#include <boost/log/attributes/mutable_constant.hpp>
+#include <boost/log/sources/record_ostream.hpp>
+
+#include "fastlog.h"
+
+RTG_INLINE_GLOBAL_LOGGER_WITH_CHANNEL(LG_FLOG, "FLOG")
+
+namespace ReadyTraderGo {
+
+namespace {
+
+constexpr auto FAST_LOG_IDLE_SLEEP = std::chrono::milliseconds(1);
+
+using ChannelLogger = boost::log::sources::severity_channel_logger<LogLevel>;
+using TimeStamp = boost::log::attributes::mutable_constant<boost::posix_time::ptime>;
+
+// A logger for one channel, owned by the formatting thread, whose time stamp
+// attribute overrides the global one with the time a record was logged.
+struct FormattingLogger
+{
+    explicit FormattingLogger(const std::string& channel)
+        : mLogger(boost::log::keywords::channel = channel),
+          mTimeStamp(boost::posix_time::ptime())
+    {
+        mLogger.add_attribute("TimeStamp", mTimeStamp);
+    }
+
+    ChannelLogger mLogger;
+    TimeStamp mTimeStamp;
+};
+
+boost::posix_time::ptime toLocalTime(std::int64_t nanoseconds)
+{
+    using adjustor = boost::date_time::c_local_adjustor<boost::posix_time::ptime>;
+    static const boost::posix_time::ptime epoch(boost::gregorian::date(1970, 1, 1));
+    return adjustor::utc_to_local(epoch + boost::posix_time::microseconds(nanoseconds / 1000));
+}
+
+template<typename C, typename T>
+void writeArgument(std::basic_ostream<C, T>& strm, const FastLogArgument& argument)
+{
+    switch (argument.mType)
+    {
+    case FastLogArgumentType::BOOLEAN:
+        strm << (argument.mUnsigned ? "true" : "false");
+        break;
+    case FastLogArgumentType::CHARACTER:
+        strm << static_cast<char>(argument.mUnsigned);
+        break;
+    case FastLogArgumentType::FLOATING:
+        strm << argument.mFloating;
+        break;
+    case FastLogArgumentType::INSTRUMENT:
+        strm << static_cast<Instrument>(argument.mUnsigned);
+        break;
+    case FastLogArgumentType::LIFESPAN:
+        strm << static_cast<Lifespan>(argument.mUnsigned);
+        break;
+    case FastLogArgumentType::SIDE:
+        strm << static_cast<Side>(argument.mUnsigned);
+        break;
+    case FastLogArgumentType::SIGNED:
+        strm << argument.mSigned;
+        break;
+    case FastLogArgumentType::UNSIGNED:
+        strm << argument.mUnsigned;
+        break;
+    }
+}
+
+template<typename C, typename T>
+void writeRecord(std::basic_ostream<C, T>& strm, const FastLogRecord& record)
+{
+    const char* format = record.mSite->mFormat;
+    std::size_t next = 0;
+    while (const char* placeholder = std::strstr(format, "{}"))
+    {
+        strm.write(format, placeholder - format);
+        if (next < record.mArgumentCount)
+        {
+            writeArgument(strm, record.mArguments[next++]);
+        }
+        format = placeholder + 2;
+    }
+    strm << format;
+}
+
+}
+
+FastLogger::~FastLogger()
+{
+    Stop();
+}
+
+void FastLogger::Start()
+{
+    if (mThread.joinable())
+    {
+        return;
+    }
+
+    // Discard anything left over from an earlier run.
+    {
+        std::lock_guard<std::mutex> lock(mProducersMutex);
+        for (auto& producer : mProducers)
+        {
+            while (producer->mQueue.Front())
+            {
+                producer->mQueue.Pop();
+            }
+        }
+    }
+
+    mIsStopping.store(false, std::memory_order_relaxed);
+    mThread = std::thread([this] { Run(); });
+    mIsRunning.store(true, std::memory_order_release);
+}
+
+void FastLogger::Stop()
+{
+    if (!mThread.joinable())
+    {
+        return;
+    }
+
+    mIsRunning.store(false, std::memory_order_relaxed);
+    mIsStopping.store(true, std::memory_order_release);
+    mThread.join();
+}
+
+FastLogger::Producer& FastLogger::GetProducer()
+{
+    thread_local Producer* producer = nullptr;
+    if (producer == nullptr)
+    {
+        std::lock_guard<std::mutex> lock(mProducersMutex);
+        producer = mProducers.emplace_back(std::make_unique<Producer>()).get();
+    }
+    return *producer;
+}
+
+bool FastLogger::Drain()
+{
+    thread_local std::map<std::string, FormattingLogger> loggers;
+
+    std::vector<Producer*> producers;
+    {
+        std::lock_guard<std::mutex> lock(mProducersMutex);
+        for (auto& producer : mProducers)
+        {
+            producers.push_back(producer.get());
+        }
+    }
+
+    bool isBusy = false;
+    for (Producer* producer : producers)
+    {
+        while (FastLogRecord* record = producer->mQueue.Front())
+        {
+            const FastLogSite& site = *record->mSite;
+            auto it = loggers.find(site.mChannel);
+            if (it == loggers.end())
+            {
+                it = loggers.emplace(site.mChannel, site.mChannel).first;
+            }
+
+            FormattingLogger& logger = it->second;
+            logger.mTimeStamp.set(toLocalTime(record->mTime));
+            if (auto rec = logger.mLogger.open_record(boost::log::keywords::severity = site.mLevel))
+            {
+                boost::log::record_ostream strm(rec);
+                writeRecord(strm.stream(), *record);
+                strm.flush();
+                logger.mLogger.push_record(std::move(rec));
+            }
+
+            producer->mQueue.Pop();
+            isBusy = true;
+        }
+
+        if (unsigned long dropped = producer->mDroppedCount.exchange(0, std::memory_order_relaxed))
+        {
+            RLOG(LG_FLOG, LogLevel::LL_WARNING) << "fast log queue full, dropped " << dropped << " records";
+        }
+    }
+
+    return isBusy;
+}
+
+void FastLogger::Run()
+{
+    while (!mIsStopping.load(std::memory_order_acquire))
+    {
+        if (!Drain())
+        {
+            std::this_thread::sleep_for(FAST_LOG_IDLE_SLEEP);
+        }
+    }
+
+    // Records logged before IsRunning was cleared are still in the rings.
+    Drain();
+}
+
+FastLogger& GetFastLogger()
+{
+    static FastLogger logger;
+    return logger;
+}
+
+}
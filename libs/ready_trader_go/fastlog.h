@@ -0,0 +1,223 @@
+// Copyright 2021 Optiver Asia Pacific Pty. Ltd.
+//
+// This file is part of Ready Trader Go.
+//
+//     Ready Trader Go is free software: you can redistribute it and/or
+//     modify it under the terms of the GNU Affero General Public License
+//     as published by the Free Software Foundation, either version 3 of
+//     the License, or (at your option) any later version.
+//
+//     Ready Trader Go is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU Affero General Public License for more details.
+//
+//     You should have received a copy of the GNU Affero General Public
+//     License along with Ready Trader Go.  If not, see
+//     <https://www.gnu.org/licenses/>.
+#ifndef CPPREADY_TRADER_GO_LIBS_READY_TRADER_GO_FASTLOG_H
+#define CPPREADY_TRADER_GO_LIBS_READY_TRADER_GO_FASTLOG_H
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#include "logging.h"
+#include "spscqueue.h"
+#include "types.h"
+
+namespace ReadyTraderGo {
+
+constexpr std::size_t FAST_LOG_MAXIMUM_ARGUMENTS = 8;
+constexpr std::size_t FAST_LOG_QUEUE_CAPACITY = 4096;
+
+// The static part of a log statement: its channel, level and format string.
+// One is created for each FLOG call site the first time it is reached.
+struct FastLogSite
+{
+    std::string mChannel;
+    LogLevel mLevel;
+    const char* mFormat;
+};
+
+enum class FastLogArgumentType : unsigned char
+{
+    BOOLEAN,
+    CHARACTER,
+    FLOATING,
+    INSTRUMENT,
+    LIFESPAN,
+    SIDE,
+    SIGNED,
+    UNSIGNED
+};
+
+struct FastLogArgument
+{
+    FastLogArgumentType mType;
+    union
+    {
+        double mFloating;
+        long long mSigned;
+        unsigned long long mUnsigned;
+    };
+};
+
+// A log statement's site, time and raw argument values, copied by the
+// calling thread and formatted later by the fast logger's thread.
+struct FastLogRecord
+{
+    FastLogSite const* mSite;
+    std::int64_t mTime;
+    std::size_t mArgumentCount;
+    std::array<FastLogArgument, FAST_LOG_MAXIMUM_ARGUMENTS> mArguments;
+};
+
+template<typename T>
+FastLogArgument makeFastLogArgument(T value) noexcept
+{
+    FastLogArgument argument;
+    if constexpr (std::is_same_v<T, bool>)
+    {
+        argument.mType = FastLogArgumentType::BOOLEAN;
+        argument.mUnsigned = value;
+    }
+    else if constexpr (std::is_same_v<T, char>)
+    {
+        argument.mType = FastLogArgumentType::CHARACTER;
+        argument.mUnsigned = static_cast<unsigned char>(value);
+    }
+    else if constexpr (std::is_same_v<T, Instrument>)
+    {
+        argument.mType = FastLogArgumentType::INSTRUMENT;
+        argument.mUnsigned = static_cast<unsigned long long>(value);
+    }
+    else if constexpr (std::is_same_v<T, Lifespan>)
+    {
+        argument.mType = FastLogArgumentType::LIFESPAN;
+        argument.mUnsigned = static_cast<unsigned long long>(value);
+    }
+    else if constexpr (std::is_same_v<T, Side>)
+    {
+        argument.mType = FastLogArgumentType::SIDE;
+        argument.mUnsigned = static_cast<unsigned long long>(value);
+    }
+    else if constexpr (std::is_floating_point_v<T>)
+    {
+        argument.mType = FastLogArgumentType::FLOATING;
+        argument.mFloating = value;
+    }
+    else if constexpr (std::is_integral_v<T> && std::is_signed_v<T>)
+    {
+        argument.mType = FastLogArgumentType::SIGNED;
+        argument.mSigned = value;
+    }
+    else
+    {
+        static_assert(std::is_integral_v<T> && std::is_unsigned_v<T>,
+                      "FLOG arguments must be numbers, characters or Ready Trader Go enumerations");
+        argument.mType = FastLogArgumentType::UNSIGNED;
+        argument.mUnsigned = value;
+    }
+    return argument;
+}
+
+// A logger for hot paths. Log statements copy their arguments into a
+// single-producer, single-consumer ring owned by the calling thread and
+// return; a background thread formats each record, replacing each "{}" in
+// the format string with the next argument, and passes it to Boost.Log with
+// the time at which it was logged. Records are dropped, and counted, if a
+// ring is full, and nothing is logged unless the fast logger is running.
+class FastLogger
+{
+public:
+    FastLogger() = default;
+    ~FastLogger();
+
+    FastLogger(const FastLogger&) = delete;
+    FastLogger& operator=(const FastLogger&) = delete;
+
+    bool IsRunning() const noexcept { return mIsRunning.load(std::memory_order_relaxed); }
+
+    // Start the formatting thread. Records logged before this are discarded.
+    void Start();
+
+    // Format any outstanding records and stop the formatting thread.
+    void Stop();
+
+    template<typename... Args>
+    void Log(const FastLogSite& site, const char* format, const Args&... args) noexcept;
+
+private:
+    using Queue = SpscQueue<FastLogRecord, FAST_LOG_QUEUE_CAPACITY>;
+
+    struct Producer
+    {
+        Queue mQueue;
+        std::atomic<unsigned long> mDroppedCount{0};
+    };
+
+    // The calling thread's ring, shared by all of its log statements so that
+    // its records are formatted in the order they were logged.
+    Producer& GetProducer();
+    bool Drain();
+    void Run();
+
+    std::atomic<bool> mIsRunning{false};
+    std::atomic<bool> mIsStopping{false};
+    std::thread mThread;
+
+    std::mutex mProducersMutex;
+    std::vector<std::unique_ptr<Producer>> mProducers;
+};
+
+FastLogger& GetFastLogger();
+
+template<typename... Args>
+void FastLogger::Log(const FastLogSite& site, const char*, const Args&... args) noexcept
+{
+    static_assert(sizeof...(Args) <= FAST_LOG_MAXIMUM_ARGUMENTS, "too many FLOG arguments");
+
+    Producer& producer = GetProducer();
+    FastLogRecord* record = producer.mQueue.Claim();
+    if (record == nullptr)
+    {
+        producer.mDroppedCount.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    record->mSite = &site;
+    record->mTime = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+    record->mArgumentCount = sizeof...(Args);
+    std::size_t i = 0;
+    ((record->mArguments[i++] = makeFastLogArgument(args)), ...);
+    producer.mQueue.Push();
+}
+
+#define RTG_FLOG_FORMAT(...) RTG_FLOG_FORMAT_(__VA_ARGS__, ~)
+#define RTG_FLOG_FORMAT_(format, ...) format
+
+// Log a format string and up to FAST_LOG_MAXIMUM_ARGUMENTS arguments through
+// the fast logger, e.g. FLOG(LG_AT, LogLevel::LL_INFO, "order {} filled", id).
+#define FLOG(loggerName, logLevel, ...) \
+    do { \
+        if (ReadyTraderGo::isLogLevelEnabled(logLevel) && ReadyTraderGo::GetFastLogger().IsRunning()) \
+        { \
+            static const ReadyTraderGo::FastLogSite rtgFastLogSite{loggerName::get().channel(), (logLevel), \
+                                                                   RTG_FLOG_FORMAT(__VA_ARGS__)}; \
+            ReadyTraderGo::GetFastLogger().Log(rtgFastLogSite, __VA_ARGS__); \
+        } \
+    } while (false)
+
+}
+
+#endif //CPPREADY_TRADER_GO_LIBS_READY_TRADER_GO_FASTLOG_H
@@ -0,0 +1,138 @@
+// Copyright 2021 Optiver Asia Pacific Pty. Ltd.
+//
+// This file is part of Ready Trader Go.
+//
+//     Ready Trader Go is free software: you can redistribute it and/or
+//     modify it under the terms of the GNU Affero General Public License
+//     as published by the Free Software Foundation, either version 3 of
+//     the License, or (at your option) any later version.
+//
+//     Ready Trader Go is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU Affero General Public License for more details.
+//
+//     You should have received a copy of the GNU Affero General Public
+//     License along with Ready Trader Go.  If not, see
+//     <https://www.gnu.org/licenses/>.
+#ifndef CPPREADY_TRADER_GO_LIBS_READY_TRADER_GO_FIXEDPOINT_H
+#define CPPREADY_TRADER_GO_LIBS_READY_TRADER_GO_FIXEDPOINT_H
+
+#include <cstdint>
+#include <ostream>
+
+namespace ReadyTraderGo {
+
+__extension__ typedef __int128 FixedPointWide;
+__extension__ typedef unsigned __int128 FixedPointUnsignedWide;
+
+// Divide numerator by a positive denominator, rounding halves away from zero.
+constexpr FixedPointWide roundedDivide(FixedPointWide numerator, FixedPointWide denominator) noexcept
+{
+    return (numerator >= 0) ? (numerator + denominator / 2) / denominator
+                            : -((-numerator + denominator / 2) / denominator);
+}
+
+// The largest integer whose square is no more than value.
+constexpr FixedPointUnsignedWide integerSquareRoot(FixedPointUnsignedWide value) noexcept
+{
+    FixedPointUnsignedWide bit = FixedPointUnsignedWide{1} << 126;
+    while (bit > value)
+    {
+        bit >>= 2;
+    }
+
+    FixedPointUnsignedWide root = 0;
+    while (bit != 0)
+    {
+        if (value >= root + bit)
+        {
+            value -= root + bit;
+            root = (root >> 1) + bit;
+        }
+        else
+        {
+            root >>= 1;
+        }
+        bit >>= 2;
+    }
+    return root;
+}
+
+// A signed number with FractionBits binary places held in a 64-bit integer.
+//
+// All arithmetic is on integers, so results are exact where the type can
+// represent them and otherwise rounded to the nearest representable value
+// the same way on every machine. Products and quotients are formed in 128
+// bits before rounding so they cannot overflow part way.
+template<unsigned FractionBits>
+class FixedPoint
+{
+public:
+    static_assert(FractionBits < 63, "FixedPoint needs at least one integer bit");
+
+    static constexpr unsigned FRACTION_BITS = FractionBits;
+    static constexpr std::int64_t ONE = std::int64_t{1} << FractionBits;
+
+    constexpr FixedPoint() noexcept = default;
+
+    static constexpr FixedPoint FromRaw(std::int64_t raw) noexcept { return FixedPoint(raw); }
+    static constexpr FixedPoint FromInteger(std::int64_t value) noexcept { return FixedPoint(value * ONE); }
+    // The nearest value to numerator / denominator, which must be positive.
+    static constexpr FixedPoint FromQuotient(std::int64_t numerator, std::int64_t denominator) noexcept
+    {
+        return FixedPoint(static_cast<std::int64_t>(
+            roundedDivide(static_cast<FixedPointWide>(numerator) * ONE, denominator)));
+    }
+    // For configuration values; keep doubles off the hot path.
+    static constexpr FixedPoint FromDouble(double value) noexcept
+    {
+        double scaled = value * static_cast<double>(ONE);
+        return FixedPoint(static_cast<std::int64_t>((scaled >= 0.0) ? scaled + 0.5 : scaled - 0.5));
+    }
+
+    constexpr std::int64_t GetRaw() const noexcept { return mRaw; }
+    constexpr double ToDouble() const noexcept { return static_cast<double>(mRaw) / static_cast<double>(ONE); }
+
+    constexpr FixedPoint operator-() const noexcept { return FixedPoint(-mRaw); }
+    constexpr FixedPoint operator+(FixedPoint other) const noexcept { return FixedPoint(mRaw + other.mRaw); }
+    constexpr FixedPoint operator-(FixedPoint other) const noexcept { return FixedPoint(mRaw - other.mRaw); }
+    constexpr FixedPoint operator*(FixedPoint other) const noexcept
+    {
+        return FixedPoint(static_cast<std::int64_t>(
+            roundedDivide(static_cast<FixedPointWide>(mRaw) * other.mRaw, ONE)));
+    }
+    constexpr FixedPoint operator*(std::int64_t factor) const noexcept { return FixedPoint(mRaw * factor); }
+    constexpr FixedPoint operator/(std::int64_t divisor) const noexcept
+    {
+        return FixedPoint(static_cast<std::int64_t>(roundedDivide(mRaw, divisor)));
+    }
+
+    constexpr bool operator==(FixedPoint other) const noexcept { return mRaw == other.mRaw; }
+    constexpr bool operator!=(FixedPoint other) const noexcept { return mRaw != other.mRaw; }
+    constexpr bool operator<(FixedPoint other) const noexcept { return mRaw < other.mRaw; }
+    constexpr bool operator<=(FixedPoint other) const noexcept { return mRaw <= other.mRaw; }
+    constexpr bool operator>(FixedPoint other) const noexcept { return mRaw > other.mRaw; }
+    constexpr bool operator>=(FixedPoint other) const noexcept { return mRaw >= other.mRaw; }
+
+private:
+    constexpr explicit FixedPoint(std::int64_t raw) noexcept : mRaw(raw) {}
+
+    std::int64_t mRaw = 0;
+};
+
+// Prices in cents, such as midpoints, with room for fractions of a cent.
+using FixedPrice = FixedPoint<16>;
+// Ratios of prices, such as the ETF/future ratio, which stay close to one.
+using FixedRatio = FixedPoint<32>;
+
+template<typename C, typename T, unsigned F>
+std::basic_ostream<C, T>& operator<<(std::basic_ostream<C, T>& strm, FixedPoint<F> value)
+{
+    strm << value.ToDouble();
+    return strm;
+}
+
+}
+
+#endif //CPPREADY_TRADER_GO_LIBS_READY_TRADER_GO_FIXEDPOINT_H
@@ -0,0 +1,170 @@
+// Copyright 2021 Optiver Asia Pacific Pty. Ltd.
+//
+// This file is part of Ready Trader Go.
+//
+//     Ready Trader Go is free software: you can redistribute it and/or
+//     modify it under the terms of the GNU Affero General Public License
+//     as published by the Free Software Foundation, either version 3 of
+//     the License, or (at your option) any later version.
+//
+//     Ready Trader Go is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU Affero General Public License for more details.
+//
+//     You should have received a copy of the GNU Affero General Public
+//     License along with Ready Trader Go.  If not, see
+//     <https://www.gnu.org/licenses/>.
+#include "hedgeengine.h"
+
+namespace ReadyTraderGo {
+
+// A hedge is due regardless of the netting window once the unhedged lots
+// are this close to the exchange's time limit.
+constexpr double UNHEDGED_LOTS_SAFETY_MARGIN = 1.0;
+
+void UnhedgedLots::ApplyPositionDelta(double now, long delta)
+{
+    long newRelativePosition = mRelativePosition + delta;
+    if (delta > 0)
+    {
+        if (mRelativePosition < -MAX_UNHEDGED_LOTS && -MAX_UNHEDGED_LOTS <= newRelativePosition)
+        {
+            mDeadline = std::numeric_limits<double>::infinity();
+        }
+        if (newRelativePosition > MAX_UNHEDGED_LOTS && MAX_UNHEDGED_LOTS >= mRelativePosition)
+        {
+            mDeadline = now + UNHEDGED_LOTS_TIME_LIMIT;
+        }
+    }
+    else if (delta < 0)
+    {
+        if (mRelativePosition > MAX_UNHEDGED_LOTS && MAX_UNHEDGED_LOTS >= newRelativePosition)
+        {
+            mDeadline = std::numeric_limits<double>::infinity();
+        }
+        if (newRelativePosition < -MAX_UNHEDGED_LOTS && -MAX_UNHEDGED_LOTS <= mRelativePosition)
+        {
+            mDeadline = now + UNHEDGED_LOTS_TIME_LIMIT;
+        }
+    }
+    mRelativePosition = newRelativePosition;
+}
+
+bool HedgeEngine::NextHedge(double now, HedgeOrder& hedge) const noexcept
+{
+    long exposure = GetExposure();
+    if (exposure == 0)
+    {
+        return false;
+    }
+
+    if (now < mExposedSince + mWindow && now < mUnhedgedLots.GetDeadline() - UNHEDGED_LOTS_SAFETY_MARGIN)
+    {
+        return false;
+    }
+
+    hedge.mSide = (exposure > 0) ? Side::BUY : Side::SELL;
+    hedge.mVolume = static_cast<unsigned long>(std::labs(exposure));
+    hedge.mPrice = LimitPrice(hedge.mSide, hedge.mVolume);
+    return true;
+}
+
+unsigned long HedgeEngine::LimitPrice(Side side, unsigned long volume) const noexcept
+{
+    // A hedge priced from this book has already failed to fill, so the book
+    // is out of date.
+    if (mIsBookStale)
+    {
+        return (side == Side::BUY) ? MAXIMUM_ASK / mTickSize * mTickSize : MINIMUM_BID;
+    }
+
+    const auto& prices = (side == Side::BUY) ? mAskPrices : mBidPrices;
+    const auto& volumes = (side == Side::BUY) ? mAskVolumes : mBidVolumes;
+
+    unsigned long available = 0;
+    for (std::size_t i = 0; i < TOP_LEVEL_COUNT && prices[i] != 0; ++i)
+    {
+        available += volumes[i];
+        if (available >= volume)
+        {
+            return prices[i];
+        }
+    }
+
+    return (side == Side::BUY) ? MAXIMUM_ASK / mTickSize * mTickSize : MINIMUM_BID;
+}
+
+void HedgeEngine::OnFutureBook(const OrderBookView& book) noexcept
+{
+    mAskPrices = book.AskPrices().ToArray();
+    mAskVolumes = book.AskVolumes().ToArray();
+    mBidPrices = book.BidPrices().ToArray();
+    mBidVolumes = book.BidVolumes().ToArray();
+    mIsBookStale = false;
+}
+
+void HedgeEngine::OnHedgeFilled(double now, unsigned long clientOrderId, unsigned long volume)
+{
+    TrackedOrder* hedge = mHedges.Find(clientOrderId);
+    if (hedge == nullptr)
+    {
+        return;
+    }
+
+    long delta = static_cast<long>(volume);
+    mUnhedgedLots.ApplyPositionDelta(now, (hedge->mSide == Side::BUY) ? delta : -delta);
+    bool isPartial = volume < hedge->mRemainingVolume;
+    mHedges.Erase(clientOrderId);
+    if (isPartial)
+    {
+        mIsBookStale = true;
+        Reexpose();
+    }
+    UpdateExposure(now);
+}
+
+void HedgeEngine::OnHedgeRejected(unsigned long clientOrderId) noexcept
+{
+    if (mHedges.Erase(clientOrderId))
+    {
+        Reexpose();
+    }
+}
+
+void HedgeEngine::OnHedgeSent(double now, unsigned long clientOrderId, const HedgeOrder& hedge)
+{
+    mHedges.Insert(clientOrderId, hedge.mSide, hedge.mPrice, hedge.mVolume);
+    UpdateExposure(now);
+}
+
+void HedgeEngine::OnOrderFilled(double now, Side side, unsigned long volume)
+{
+    long delta = static_cast<long>(volume);
+    mUnhedgedLots.ApplyPositionDelta(now, (side == Side::BUY) ? delta : -delta);
+    UpdateExposure(now);
+}
+
+void HedgeEngine::Reexpose() noexcept
+{
+    // The exposure a failed hedge was meant to cover dates from before it
+    // was sent, so it is due again at once.
+    if (GetExposure() != 0)
+    {
+        mExposedSince = -std::numeric_limits<double>::infinity();
+    }
+}
+
+void HedgeEngine::UpdateExposure(double now) noexcept
+{
+    if (GetExposure() == 0)
+    {
+        mExposedSince = std::numeric_limits<double>::infinity();
+    }
+    else if (mExposedSince == std::numeric_limits<double>::infinity())
+    {
+        mExposedSince = now;
+    }
+}
+
+}
@@ -0,0 +1,118 @@
+// Copyright 2021 Optiver Asia Pacific Pty. Ltd.
+//
+// This file is part of Ready Trader Go.
+//
+//     Ready Trader Go is free software: you can redistribute it and/or
+//     modify it under the terms of the GNU Affero General Public License
+//     as published by the Free Software Foundation, either version 3 of
+//     the License, or (at your option) any later version.
+//
+//     Ready Trader Go is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU Affero General Public License for more details.
+//
+//     You should have received a copy of the GNU Affero General Public
+//     License along with Ready Trader Go.  If not, see
+//     <https://www.gnu.org/licenses/>.
+#ifndef CPPREADY_TRADER_GO_LIBS_READY_TRADER_GO_HEDGEENGINE_H
+#define CPPREADY_TRADER_GO_LIBS_READY_TRADER_GO_HEDGEENGINE_H
+
+#include <array>
+#include <cstdlib>
+#include <limits>
+
+#include "ordertable.h"
+#include "protocol.h"
+#include "types.h"
+
+namespace ReadyTraderGo {
+
+// Competitors may hold more than MAX_UNHEDGED_LOTS unhedged ETF lots for at
+// most UNHEDGED_LOTS_TIME_LIMIT seconds.
+constexpr long MAX_UNHEDGED_LOTS = 10;
+constexpr double UNHEDGED_LOTS_TIME_LIMIT = 60.0;
+
+// Tracks the difference between a competitor's ETF and future positions and
+// the time at which too many unhedged lots will have been held for too long.
+class UnhedgedLots
+{
+public:
+    void ApplyPositionDelta(double now, long delta);
+    bool HasExpired(double now) const noexcept { return now >= mDeadline; }
+    double GetDeadline() const noexcept { return mDeadline; }
+    long GetRelativePosition() const noexcept { return mRelativePosition; }
+
+private:
+    long mRelativePosition = 0;
+    double mDeadline = std::numeric_limits<double>::infinity();
+};
+
+struct HedgeOrder
+{
+    Side mSide = Side::BUY;
+    unsigned long mPrice = 0;
+    unsigned long mVolume = 0;
+};
+
+// Nets ETF fills into future hedges.
+//
+// The engine tracks the unhedged ETF lots in the same way as the exchange
+// and the hedges in flight. Fills arriving within the netting window of the
+// first unhedged fill are combined into one hedge; a hedge is due at once if
+// the unhedged lots are close to the exchange's time limit. The hedge's
+// limit price is the price of the level in the latest future order book
+// that covers its volume, falling back to the most aggressive valid price
+// when the visible levels do not.
+//
+// Hedges are filled immediately or not at all, so any volume a hedge fails
+// to fill is hedged again by the next one, at the most aggressive valid
+// price until a new future order book arrives.
+class HedgeEngine
+{
+public:
+    explicit HedgeEngine(double window = 0.0, unsigned long tickSize = 100) : mWindow(window), mTickSize(tickSize) {}
+
+    // Return the hedge, if any, that should be sent now. The caller must
+    // report a hedge it sends to OnHedgeSent.
+    bool NextHedge(double now, HedgeOrder& hedge) const noexcept;
+
+    void OnFutureBook(const OrderBookView& book) noexcept;
+    void OnHedgeFilled(double now, unsigned long clientOrderId, unsigned long volume);
+    void OnHedgeRejected(unsigned long clientOrderId) noexcept;
+    void OnHedgeSent(double now, unsigned long clientOrderId, const HedgeOrder& hedge);
+    void OnOrderFilled(double now, Side side, unsigned long volume);
+
+    // Future lots to buy (positive) or sell (negative) once the hedges in
+    // flight have been filled.
+    long GetExposure() const noexcept
+    {
+        return -mUnhedgedLots.GetRelativePosition() - static_cast<long>(mHedges.GetVolume(Side::BUY))
+               + static_cast<long>(mHedges.GetVolume(Side::SELL));
+    }
+    const UnhedgedLots& GetUnhedgedLots() const noexcept { return mUnhedgedLots; }
+
+private:
+    unsigned long LimitPrice(Side side, unsigned long volume) const noexcept;
+    void Reexpose() noexcept;
+    void UpdateExposure(double now) noexcept;
+
+    double mWindow;
+    unsigned long mTickSize;
+
+    UnhedgedLots mUnhedgedLots;
+    OrderTable mHedges;
+    // Time at which the current exposure first appeared.
+    double mExposedSince = std::numeric_limits<double>::infinity();
+    // True if a hedge failed to fill after the latest future order book.
+    bool mIsBookStale = false;
+
+    std::array<unsigned long, TOP_LEVEL_COUNT> mAskPrices{};
+    std::array<unsigned long, TOP_LEVEL_COUNT> mAskVolumes{};
+    std::array<unsigned long, TOP_LEVEL_COUNT> mBidPrices{};
+    std::array<unsigned long, TOP_LEVEL_COUNT> mBidVolumes{};
+};
+
+}
+
+#endif //CPPREADY_TRADER_GO_LIBS_READY_TRADER_GO_HEDGEENGINE_H
@@ -0,0 +1,158 @@
+// Copyright 2021 Optiver Asia Pacific Pty. Ltd.
+//
+// This file is part of Ready Trader Go.
+//
+//     Ready Trader Go is free software: you can redistribute it and/or
+//     modify it under the terms of the GNU Affero General Public License
+//     as published by the Free Software Foundation, either version 3 of
+//     the License, or (at your option) any later version.
+//
+//     Ready Trader Go is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU Affero General Public License for more details.
+//
+//     You should have received a copy of the GNU Affero General Public
+//     License along with Ready Trader Go.  If not, see
+//     <https://www.gnu.org/licenses/>.
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "latency.h"
+
+namespace ReadyTraderGo {
+
+std::uint64_t LatencyHistogram::GetValueAtPercentile(double percentile) const noexcept
+{
+    if (mCount == 0)
+        return 0;
+
+    auto target = static_cast<std::uint64_t>(std::ceil(percentile / 100.0 * double(mCount)));
+    if (target == 0)
+        target = 1;
+
+    std::uint64_t seen = 0;
+    for (std::size_t i = 0; i < BUCKET_COUNT; ++i)
+    {
+        seen += mCounts[i];
+        if (seen >= target)
+            return std::min(HighestValueAt(i), mMax);
+    }
+    return mMax;
+}
+
+void LatencyRecorder::Decoded() noexcept
+{
+    if (mSeenAt == 0)
+        return;
+    mDecodedAt = LatencyTimestamp();
+    Record(mSource == Source::INFORMATION ? LatencyStage::DETECT_TO_DECODE : LatencyStage::RECEIVE_TO_DECODE,
+           mSeenAt, mDecodedAt);
+}
+
+void LatencyRecorder::HandlerEntered() noexcept
+{
+    if (mSeenAt == 0)
+        return;
+    mHandlerAt = LatencyTimestamp();
+    if (mDecodedAt != 0)
+        Record(LatencyStage::DECODE_TO_HANDLER, mDecodedAt, mHandlerAt);
+}
+
+void LatencyRecorder::HandlerExited() noexcept
+{
+    if (mSeenAt == 0 || mHandlerAt == 0)
+        return;
+    Record(LatencyStage::HANDLER, mHandlerAt, LatencyTimestamp());
+}
+
+void LatencyRecorder::SocketWritten() noexcept
+{
+    const std::uint64_t now = LatencyTimestamp();
+    for (std::size_t i = 0; i < mDeferredCount; ++i)
+    {
+        mDeferred[i].mWrittenAt = now;
+        RecordWrite(mDeferred[i]);
+    }
+    mDeferredCount = 0;
+
+    if (mRelayed.mSeenAt != 0)
+    {
+        if (mRelayed.mWrittenAt == 0)
+            mRelayed.mWrittenAt = now;
+        return;
+    }
+
+    if (mSeenAt == 0 || !mIsWritePending)
+        return;
+    mIsWritePending = false;
+    RecordWrite(Trace{mSource, mSeenAt, mHandlerAt, now});
+}
+
+void LatencyRecorder::WriteDeferred() noexcept
+{
+    if (mDeferredCount < mDeferred.size() && HandOffWrite(mDeferred[mDeferredCount]))
+        ++mDeferredCount;
+}
+
+bool LatencyRecorder::HandOffWrite(Trace& trace) noexcept
+{
+    if (mSeenAt == 0 || !mIsWritePending)
+        return false;
+    mIsWritePending = false;
+    trace = Trace{mSource, mSeenAt, mHandlerAt, 0};
+    return true;
+}
+
+bool LatencyRecorder::TakeRelayed(Trace& trace) noexcept
+{
+    if (mRelayed.mWrittenAt == 0)
+        return false;
+    trace = mRelayed;
+    mRelayed = Trace{};
+    return true;
+}
+
+void LatencyRecorder::RecordWrite(const Trace& trace) noexcept
+{
+    if (trace.mHandlerAt != 0)
+        Record(LatencyStage::HANDLER_TO_WRITE, trace.mHandlerAt, trace.mWrittenAt);
+    Record(trace.mSource == Source::INFORMATION ? LatencyStage::TICK_TO_TRADE : LatencyStage::FILL_TO_WRITE,
+           trace.mSeenAt, trace.mWrittenAt);
+}
+
+std::vector<std::string> LatencyRecorder::Report() const
+{
+    std::vector<std::string> lines;
+    for (std::size_t i = 0; i < mHistograms.size(); ++i)
+    {
+        const auto& histogram = mHistograms[i];
+        std::ostringstream line;
+        line << std::fixed << std::setprecision(3) << std::left << std::setw(16) << LATENCY_STAGE_NAMES[i]
+             << " count=" << histogram.GetCount()
+             << " min=" << histogram.GetMin() / 1000.0
+             << " mean=" << histogram.GetMean() / 1000.0;
+        line << " p50=" << histogram.GetValueAtPercentile(50.0) / 1000.0
+             << " p90=" << histogram.GetValueAtPercentile(90.0) / 1000.0
+             << " p99=" << histogram.GetValueAtPercentile(99.0) / 1000.0
+             << " p99.9=" << histogram.GetValueAtPercentile(99.9) / 1000.0
+             << " p99.99=" << histogram.GetValueAtPercentile(99.99) / 1000.0;
+        line << " max=" << histogram.GetMax() / 1000.0 << " (us)";
+        lines.emplace_back(line.str());
+    }
+    return lines;
+}
+
+LatencyRecorder& GetLatencyRecorder()
+{
+    // One recorder per thread so that in-process replays running in
+    // parallel do not share histograms.
+    static thread_local LatencyRecorder recorder;
+    return recorder;
+}
+
+}
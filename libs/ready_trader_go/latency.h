@@ -0,0 +1,224 @@
+// Copyright 2021 Optiver Asia Pacific Pty. Ltd.
+//
+// This file is part of Ready Trader Go.
+//
+//     Ready Trader Go is free software: you can redistribute it and/or
+//     modify it under the terms of the GNU Affero General Public License
+//     as published by the Free Software Foundation, either version 3 of
+//     the License, or (at your option) any later version.
+//
+//     Ready Trader Go is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU Affero General Public License for more details.
+//
+//     You should have received a copy of the GNU Affero General Public
+//     License along with Ready Trader Go.  If not, see
+//     <https://www.gnu.org/licenses/>.
+#ifndef CPPREADY_TRADER_GO_LIBS_READY_TRADER_GO_LATENCY_H
+#define CPPREADY_TRADER_GO_LIBS_READY_TRADER_GO_LATENCY_H
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace ReadyTraderGo {
+
+#ifdef RTG_LATENCY_STATS
+constexpr bool LATENCY_STATS_ENABLED = true;
+#else
+constexpr bool LATENCY_STATS_ENABLED = false;
+#endif
+
+// Return a steady clock timestamp in nanoseconds, or zero when latency
+// statistics are compiled out.
+inline std::uint64_t LatencyTimestamp() noexcept
+{
+    if constexpr (LATENCY_STATS_ENABLED)
+    {
+        auto now = std::chrono::steady_clock::now().time_since_epoch();
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(now).count();
+    }
+    return 0;
+}
+
+// A high-dynamic-range histogram of nanosecond latencies. Values are
+// counted in log-linear buckets: exact below 128ns and to within 1/64
+// (about 1.5%) above, across the full 64-bit range, in fixed storage.
+class LatencyHistogram
+{
+public:
+    static constexpr std::size_t SUB_BUCKET_BITS = 7;
+    static constexpr std::size_t SUB_BUCKET_HALF = std::size_t(1) << (SUB_BUCKET_BITS - 1);
+    static constexpr std::size_t BUCKET_COUNT = (64 - SUB_BUCKET_BITS + 2) * SUB_BUCKET_HALF;
+
+    void Record(std::uint64_t value) noexcept
+    {
+        ++mCounts[IndexOf(value)];
+        ++mCount;
+        mSum += value;
+        if (value > mMax)
+            mMax = value;
+        if (value < mMin)
+            mMin = value;
+    }
+
+    std::uint64_t GetCount() const noexcept { return mCount; }
+    std::uint64_t GetMax() const noexcept { return mMax; }
+    std::uint64_t GetMin() const noexcept { return mCount ? mMin : 0; }
+    double GetMean() const noexcept { return mCount ? double(mSum) / double(mCount) : 0.0; }
+
+    // Return the highest value equivalent to the given percentile (0-100).
+    std::uint64_t GetValueAtPercentile(double percentile) const noexcept;
+
+    static std::size_t IndexOf(std::uint64_t value) noexcept
+    {
+        if (value < 2 * SUB_BUCKET_HALF)
+            return value;
+        const std::size_t shift = MostSignificantBit(value) - (SUB_BUCKET_BITS - 1);
+        return SUB_BUCKET_HALF * shift + (value >> shift);
+    }
+
+    // The highest value counted in the bucket at the given index.
+    static std::uint64_t HighestValueAt(std::size_t index) noexcept
+    {
+        if (index < 2 * SUB_BUCKET_HALF)
+            return index;
+        const std::size_t shift = index / SUB_BUCKET_HALF - 1;
+        const std::uint64_t subBucket = index - SUB_BUCKET_HALF * shift;
+        return (subBucket << shift) + ((std::uint64_t(1) << shift) - 1);
+    }
+
+private:
+    static std::size_t MostSignificantBit(std::uint64_t value) noexcept
+    {
+#if defined(__GNUC__)
+        return 63 - __builtin_clzll(value);
+#else
+        std::size_t bit = 0;
+        while (value >>= 1)
+            ++bit;
+        return bit;
+#endif
+    }
+
+    std::array<std::uint64_t, BUCKET_COUNT> mCounts = {};
+    std::uint64_t mCount = 0;
+    std::uint64_t mSum = 0;
+    std::uint64_t mMax = 0;
+    std::uint64_t mMin = UINT64_MAX;
+};
+
+enum class LatencyStage : unsigned char
+{
+    DETECT_TO_DECODE,   // information frame detected to message decoded
+    RECEIVE_TO_DECODE,  // execution message read to message decoded
+    DECODE_TO_HANDLER,  // message decoded to strategy handler entry
+    HANDLER,            // strategy handler entry to exit
+    HANDLER_TO_WRITE,   // strategy handler entry to first socket write
+    TICK_TO_TRADE,      // information frame detected to first socket write
+    FILL_TO_WRITE,      // execution message read to first socket write
+    COUNT
+};
+
+constexpr const char* LATENCY_STAGE_NAMES[] = {
+    "detect->decode",
+    "receive->decode",
+    "decode->handler",
+    "handler",
+    "handler->write",
+    "tick->trade",
+    "fill->write"
+};
+
+// Follows each inbound message from the moment it is seen, through decoding
+// and the strategy handler, to the first socket write it causes, recording
+// the time spent in each stage. Only one message is traced at a time, which
+// matches the single-threaded dispatch of the event loop. When the socket is
+// written by another thread, the message's trace is handed to that thread's
+// recorder, which times the write, and then handed back to be recorded.
+class LatencyRecorder
+{
+public:
+    enum class Source : unsigned char { INFORMATION, EXECUTION };
+
+    // The timestamps of a message whose first socket write is timed on
+    // another thread. A trace with no seenAt is empty.
+    struct Trace
+    {
+        Source mSource = Source::INFORMATION;
+        std::uint64_t mSeenAt = 0;
+        std::uint64_t mHandlerAt = 0;
+        std::uint64_t mWrittenAt = 0;
+    };
+
+    void BeginMessage(Source source, std::uint64_t seenAt) noexcept
+    {
+        mSource = source;
+        mSeenAt = seenAt;
+        mDecodedAt = mHandlerAt = 0;
+        mIsWritePending = true;
+    }
+
+    void Decoded() noexcept;
+    void HandlerEntered() noexcept;
+    void HandlerExited() noexcept;
+    void SocketWritten() noexcept;
+    // The current message's requests will be written after it has been
+    // handled, e.g. behind a write already in progress, so its first write is
+    // timed by the next SocketWritten whatever message is current then.
+    void WriteDeferred() noexcept;
+    void EndMessage() noexcept { mSeenAt = 0; }
+
+    // When the current message was seen, or zero outside of a message.
+    std::uint64_t GetSeenAt() const noexcept { return mSeenAt; }
+
+    // Take the trace of the current message if its first write is pending.
+    bool HandOffWrite(Trace& trace) noexcept;
+    // Time the next socket write on this thread for the given trace, which
+    // replaces any trace whose write has not happened yet.
+    void RelayWrite(const Trace& trace) noexcept { mRelayed = trace; }
+    // Take the relayed trace once its write has been timed.
+    bool TakeRelayed(Trace& trace) noexcept;
+    // Record the stages ending at the write of a handed off trace.
+    void RecordWrite(const Trace& trace) noexcept;
+
+    const LatencyHistogram& GetHistogram(LatencyStage stage) const noexcept
+    {
+        return mHistograms[static_cast<std::size_t>(stage)];
+    }
+
+    // One line per stage with a count, summarising percentiles in microseconds.
+    std::vector<std::string> Report() const;
+
+private:
+    void Record(LatencyStage stage, std::uint64_t from, std::uint64_t to) noexcept
+    {
+        mHistograms[static_cast<std::size_t>(stage)].Record(to - from);
+    }
+
+    std::array<LatencyHistogram, static_cast<std::size_t>(LatencyStage::COUNT)> mHistograms;
+    Source mSource = Source::INFORMATION;
+    std::uint64_t mSeenAt = 0;
+    std::uint64_t mDecodedAt = 0;
+    std::uint64_t mHandlerAt = 0;
+    bool mIsWritePending = false;
+    Trace mRelayed;
+    // Traces whose first write was deferred, oldest first; any beyond the
+    // capacity are dropped.
+    std::array<Trace, 16> mDeferred;
+    std::size_t mDeferredCount = 0;
+};
+
+LatencyRecorder& GetLatencyRecorder();
+
+// Trace points. These compile to nothing unless RTG_LATENCY_STATS is defined.
+#define RTG_LATENCY_POINT(call) \
+    do { if constexpr (ReadyTraderGo::LATENCY_STATS_ENABLED) ReadyTraderGo::GetLatencyRecorder().call; } while (false)
+
+}
+
+#endif //CPPREADY_TRADER_GO_LIBS_READY_TRADER_GO_LATENCY_H
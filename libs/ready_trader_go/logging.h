@@ -57,7 +57,25 @@ std::basic_ostream<C, T>& operator<<(std::basic_ostream<C, T>& strm, LogLevel lv
         boost::log::sources::severity_channel_logger<ReadyTraderGo::LogLevel>,\
         (boost::log::keywords::channel = (channelName)));
 
-#define RLOG(loggerName, logLevel) BOOST_LOG_SEV(loggerName::get(), (logLevel))
+// Log statements below the minimum level compile to nothing. The level can be
+// set with the RTG_MIN_LOG_LEVEL macro (0 for DEBUG up to 4 for FATAL) and
+// otherwise matches the sink filter: DEBUG statements are kept only in builds
+// without NDEBUG.
+#if defined(RTG_MIN_LOG_LEVEL)
+constexpr LogLevel MINIMUM_LOG_LEVEL = static_cast<LogLevel>(RTG_MIN_LOG_LEVEL);
+#elif defined(NDEBUG)
+constexpr LogLevel MINIMUM_LOG_LEVEL = LogLevel::LL_INFO;
+#else
+constexpr LogLevel MINIMUM_LOG_LEVEL = LogLevel::LL_DEBUG;
+#endif
+
+constexpr bool isLogLevelEnabled(LogLevel lvl) noexcept
+{
+    return lvl >= MINIMUM_LOG_LEVEL;
+}
+
+#define RLOG(loggerName, logLevel) \
+    if (!ReadyTraderGo::isLogLevelEnabled(logLevel)) {} else BOOST_LOG_SEV(loggerName::get(), (logLevel))
 }
 
 #endif //CPPREADY_TRADER_GO_LIBS_READY_TRADER_GO_LOGGING_H
@@ -0,0 +1,253 @@
+// Copyright 2021 Optiver Asia Pacific Pty. Ltd.
+//
+// This file is part of Ready Trader Go.
+//
+//     Ready Trader Go is free software: you can redistribute it and/or
+//     modify it under the terms of the GNU Affero General Public License
+//     as published by the Free Software Foundation, either version 3 of
+//     the License, or (at your option) any later version.
+//
+//     Ready Trader Go is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU Affero General Public License for more details.
+//
+//     You should have received a copy of the GNU Affero General Public
+//     License along with Ready Trader Go.  If not, see
+//     <https://www.gnu.org/licenses/>.
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#include "error.h"
+#include "marketdata.h"
+
+namespace ReadyTraderGo {
+
+MarketDataCsvReader::MarketDataCsvReader(const std::string& filename) : mStream(filename)
+{
+    if (!mStream)
+    {
+        throw ReadyTraderGoError("failed to open market data file: " + filename);
+    }
+    // Skip the header row
+    std::getline(mStream, mLine);
+}
+
+bool MarketDataCsvReader::Next(MarketEvent& event)
+{
+    if (!std::getline(mStream, mLine))
+    {
+        return false;
+    }
+    ++mLineNumber;
+
+    char const* fields[8];
+    std::size_t count = 0;
+    char const* p = mLine.c_str();
+    fields[count++] = p;
+    for (; *p && count < 8; ++p)
+    {
+        if (*p == ',')
+        {
+            fields[count++] = p + 1;
+        }
+    }
+    if (count != 8)
+    {
+        throw ReadyTraderGoError("malformed market data at line " + std::to_string(mLineNumber));
+    }
+
+    auto isEmpty = [](char const* field) { return *field == ',' || *field == '\0' || *field == '\r'; };
+
+    event.mTime = std::strtod(fields[0], nullptr);
+    event.mInstrument = static_cast<Instrument>(std::strtoul(fields[1], nullptr, 10));
+    switch (*fields[2])
+    {
+    case 'A':
+        event.mOperation = MarketEventOperation::AMEND;
+        break;
+    case 'C':
+        event.mOperation = MarketEventOperation::CANCEL;
+        break;
+    case 'I':
+        event.mOperation = MarketEventOperation::INSERT;
+        break;
+    default:
+        throw ReadyTraderGoError("unknown market data operation at line " + std::to_string(mLineNumber));
+    }
+    event.mOrderId = std::strtoul(fields[3], nullptr, 10);
+    event.mSide = (*fields[4] == 'A') ? Side::SELL : Side::BUY;
+    event.mVolume = isEmpty(fields[5]) ? 0 : static_cast<long>(std::strtod(fields[5], nullptr));
+    event.mPrice = isEmpty(fields[6])
+                   ? 0 : static_cast<unsigned long>(std::strtod(fields[6], nullptr) * MARKET_DATA_PRICE_SCALING);
+    event.mLifespan = (*fields[7] == 'G') ? Lifespan::GOOD_FOR_DAY : Lifespan::FILL_AND_KILL;
+    return true;
+}
+
+namespace {
+
+// Offsets of each column from the start of a file holding count events.
+struct ColumnOffsets
+{
+    explicit ColumnOffsets(std::uint64_t count)
+        : mTimes(sizeof(MarketDataFileHeader)),
+          mOrderIds(mTimes + count * sizeof(double)),
+          mVolumes(mOrderIds + count * sizeof(std::uint64_t)),
+          mPrices(mVolumes + count * sizeof(std::int32_t)),
+          mInstruments(mPrices + count * sizeof(std::uint32_t)),
+          mOperations(mInstruments + count),
+          mSides(mOperations + count),
+          mLifespans(mSides + count),
+          mEnd(mLifespans + count) {}
+
+    std::uint64_t mTimes;
+    std::uint64_t mOrderIds;
+    std::uint64_t mVolumes;
+    std::uint64_t mPrices;
+    std::uint64_t mInstruments;
+    std::uint64_t mOperations;
+    std::uint64_t mSides;
+    std::uint64_t mLifespans;
+    std::uint64_t mEnd;
+};
+
+template<typename T>
+void writeColumn(std::ofstream& stream, const std::vector<T>& column)
+{
+    stream.write(reinterpret_cast<char const*>(column.data()),
+                 static_cast<std::streamsize>(column.size() * sizeof(T)));
+}
+
+}
+
+std::uint64_t WriteMarketDataFile(IMarketEventSource& source, const std::string& filename)
+{
+    std::vector<double> times;
+    std::vector<std::uint64_t> orderIds;
+    std::vector<std::int32_t> volumes;
+    std::vector<std::uint32_t> prices;
+    std::vector<unsigned char> instruments;
+    std::vector<unsigned char> operations;
+    std::vector<unsigned char> sides;
+    std::vector<unsigned char> lifespans;
+
+    MarketEvent event;
+    while (source.Next(event))
+    {
+        times.push_back(event.mTime);
+        orderIds.push_back(event.mOrderId);
+        volumes.push_back(static_cast<std::int32_t>(event.mVolume));
+        prices.push_back(static_cast<std::uint32_t>(event.mPrice));
+        instruments.push_back(static_cast<unsigned char>(event.mInstrument));
+        operations.push_back(static_cast<unsigned char>(event.mOperation));
+        sides.push_back(static_cast<unsigned char>(event.mSide));
+        lifespans.push_back(static_cast<unsigned char>(event.mLifespan));
+    }
+
+    std::ofstream stream{filename, std::ios_base::binary | std::ios_base::trunc};
+    if (!stream)
+    {
+        throw ReadyTraderGoError("failed to open market data file for writing: " + filename);
+    }
+
+    MarketDataFileHeader header{};
+    std::memcpy(header.mMagic, MARKET_DATA_FILE_MAGIC, sizeof(header.mMagic));
+    header.mEventCount = times.size();
+    stream.write(reinterpret_cast<char const*>(&header), sizeof(header));
+    writeColumn(stream, times);
+    writeColumn(stream, orderIds);
+    writeColumn(stream, volumes);
+    writeColumn(stream, prices);
+    writeColumn(stream, instruments);
+    writeColumn(stream, operations);
+    writeColumn(stream, sides);
+    writeColumn(stream, lifespans);
+
+    if (!stream.flush())
+    {
+        throw ReadyTraderGoError("failed while writing market data file: " + filename);
+    }
+    return header.mEventCount;
+}
+
+MarketDataFileReader::MarketDataFileReader(const std::string& filename)
+{
+    try
+    {
+        mFile = boost::interprocess::file_mapping(filename.c_str(), boost::interprocess::read_only);
+        mRegion = boost::interprocess::mapped_region(mFile, boost::interprocess::read_only);
+    }
+    catch (const boost::interprocess::interprocess_exception& e)
+    {
+        throw ReadyTraderGoError("failed to map market data file: " + filename + ": " + e.what());
+    }
+
+    auto base = static_cast<unsigned char const*>(mRegion.get_address());
+    MarketDataFileHeader header;
+    if (mRegion.get_size() < sizeof(header))
+    {
+        throw ReadyTraderGoError("market data file is truncated: " + filename);
+    }
+    std::memcpy(&header, base, sizeof(header));
+    if (std::memcmp(header.mMagic, MARKET_DATA_FILE_MAGIC, sizeof(header.mMagic)) != 0)
+    {
+        throw ReadyTraderGoError("not a binary market data file: " + filename);
+    }
+
+    ColumnOffsets offsets{header.mEventCount};
+    if (mRegion.get_size() < offsets.mEnd)
+    {
+        throw ReadyTraderGoError("market data file is truncated: " + filename);
+    }
+
+    mEventCount = header.mEventCount;
+    mTimes = reinterpret_cast<double const*>(base + offsets.mTimes);
+    mOrderIds = reinterpret_cast<std::uint64_t const*>(base + offsets.mOrderIds);
+    mVolumes = reinterpret_cast<std::int32_t const*>(base + offsets.mVolumes);
+    mPrices = reinterpret_cast<std::uint32_t const*>(base + offsets.mPrices);
+    mInstruments = base + offsets.mInstruments;
+    mOperations = base + offsets.mOperations;
+    mSides = base + offsets.mSides;
+    mLifespans = base + offsets.mLifespans;
+
+    mRegion.advise(boost::interprocess::mapped_region::advice_sequential);
+}
+
+bool MarketDataFileReader::Next(MarketEvent& event)
+{
+    if (mNext == mEventCount)
+    {
+        return false;
+    }
+
+    std::uint64_t i = mNext++;
+    event.mTime = mTimes[i];
+    event.mInstrument = static_cast<Instrument>(mInstruments[i]);
+    event.mOperation = static_cast<MarketEventOperation>(mOperations[i]);
+    event.mOrderId = mOrderIds[i];
+    event.mSide = static_cast<Side>(mSides[i]);
+    event.mVolume = mVolumes[i];
+    event.mPrice = mPrices[i];
+    event.mLifespan = static_cast<Lifespan>(mLifespans[i]);
+    return true;
+}
+
+bool IsMarketDataFile(const std::string& filename)
+{
+    std::ifstream stream{filename, std::ios_base::binary};
+    char magic[sizeof(MARKET_DATA_FILE_MAGIC)] = {};
+    stream.read(magic, sizeof(magic));
+    return stream && std::memcmp(magic, MARKET_DATA_FILE_MAGIC, sizeof(magic)) == 0;
+}
+
+std::unique_ptr<IMarketEventSource> OpenMarketData(const std::string& filename)
+{
+    if (IsMarketDataFile(filename))
+    {
+        return std::make_unique<MarketDataFileReader>(filename);
+    }
+    return std::make_unique<MarketDataCsvReader>(filename);
+}
+
+}
@@ -0,0 +1,134 @@
+// Copyright 2021 Optiver Asia Pacific Pty. Ltd.
+//
+// This file is part of Ready Trader Go.
+//
+//     Ready Trader Go is free software: you can redistribute it and/or
+//     modify it under the terms of the GNU Affero General Public License
+//     as published by the Free Software Foundation, either version 3 of
+//     the License, or (at your option) any later version.
+//
+//     Ready Trader Go is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU Affero General Public License for more details.
+//
+//     You should have received a copy of the GNU Affero General Public
+//     License along with Ready Trader Go.  If not, see
+//     <https://www.gnu.org/licenses/>.
+#ifndef CPPREADY_TRADER_GO_LIBS_READY_TRADER_GO_MARKETDATA_H
+#define CPPREADY_TRADER_GO_LIBS_READY_TRADER_GO_MARKETDATA_H
+
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <string>
+
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+
+#include "types.h"
+
+namespace ReadyTraderGo {
+
+// Prices in market data files are in dollars and are scaled to cents.
+constexpr double MARKET_DATA_PRICE_SCALING = 100.0;
+
+enum class MarketEventOperation : unsigned char { AMEND, CANCEL, INSERT };
+
+// An order event from a market data file. For amends the volume is the
+// (negative) change in volume; cancels carry only an order id.
+struct MarketEvent
+{
+    double mTime = 0.0;
+    Instrument mInstrument = Instrument::FUTURE;
+    MarketEventOperation mOperation = MarketEventOperation::CANCEL;
+    unsigned long mOrderId = 0;
+    Side mSide = Side::BUY;
+    long mVolume = 0;
+    unsigned long mPrice = 0;
+    Lifespan mLifespan = Lifespan::FILL_AND_KILL;
+};
+
+struct IMarketEventSource
+{
+    virtual ~IMarketEventSource() = default;
+
+    // Read the next event, returning false at the end of the data.
+    virtual bool Next(MarketEvent& event) = 0;
+};
+
+// Reads market events from a CSV file with the columns
+// Time,Instrument,Operation,OrderId,Side,Volume,Price,Lifespan.
+class MarketDataCsvReader : public IMarketEventSource
+{
+public:
+    explicit MarketDataCsvReader(const std::string& filename);
+
+    bool Next(MarketEvent& event) override;
+
+private:
+    std::ifstream mStream;
+    std::string mLine;
+    unsigned long mLineNumber = 1;
+};
+
+// Binary market data files hold the same events as the CSV files in
+// fixed-width columns so they can be memory mapped and read without
+// parsing. The file starts with a header followed by one column per field,
+// widest first so that every column is naturally aligned:
+//
+//    header    - an eight-byte magic value and an eight-byte event count;
+//    time      - double;
+//    order id  - uint64;
+//    volume    - int32;
+//    price     - uint32;
+//    instrument, operation, side and lifespan - one byte each.
+//
+// All values are in native byte order.
+constexpr char MARKET_DATA_FILE_MAGIC[8] = {'R', 'T', 'G', 'M', 'D', 'A', 'T', '1'};
+
+struct MarketDataFileHeader
+{
+    char mMagic[8];
+    std::uint64_t mEventCount;
+};
+
+// Read every event from source and write them to filename in the binary
+// format. Returns the number of events written.
+std::uint64_t WriteMarketDataFile(IMarketEventSource& source, const std::string& filename);
+
+// Reads market events from a memory mapped binary market data file.
+class MarketDataFileReader : public IMarketEventSource
+{
+public:
+    explicit MarketDataFileReader(const std::string& filename);
+
+    bool Next(MarketEvent& event) override;
+
+    std::uint64_t GetEventCount() const noexcept { return mEventCount; }
+
+private:
+    boost::interprocess::file_mapping mFile;
+    boost::interprocess::mapped_region mRegion;
+    std::uint64_t mEventCount = 0;
+    std::uint64_t mNext = 0;
+
+    double const* mTimes = nullptr;
+    std::uint64_t const* mOrderIds = nullptr;
+    std::int32_t const* mVolumes = nullptr;
+    std::uint32_t const* mPrices = nullptr;
+    unsigned char const* mInstruments = nullptr;
+    unsigned char const* mOperations = nullptr;
+    unsigned char const* mSides = nullptr;
+    unsigned char const* mLifespans = nullptr;
+};
+
+// Return true if filename starts with the binary market data file magic.
+bool IsMarketDataFile(const std::string& filename);
+
+// Open a market data file in either the CSV or the binary format.
+std::unique_ptr<IMarketEventSource> OpenMarketData(const std::string& filename);
+
+}
+
+#endif //CPPREADY_TRADER_GO_LIBS_READY_TRADER_GO_MARKETDATA_H
@@ -0,0 +1,97 @@
+// Copyright 2021 Optiver Asia Pacific Pty. Ltd.
+//
+// This file is part of Ready Trader Go.
+//
+//     Ready Trader Go is free software: you can redistribute it and/or
+//     modify it under the terms of the GNU Affero General Public License
+//     as published by the Free Software Foundation, either version 3 of
+//     the License, or (at your option) any later version.
+//
+//     Ready Trader Go is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU Affero General Public License for more details.
+//
+//     You should have received a copy of the GNU Affero General Public
+//     License along with Ready Trader Go.  If not, see
+//     <https://www.gnu.org/licenses/>.
+#include <cstdint>
+
+#include "marketstate.h"
+
+namespace ReadyTraderGo {
+
+BookChanges MarketState::OnOrderBook(const OrderBookView& book) noexcept
+{
+    const BookChanges changes = mBooks.Update(book);
+    if ((changes & BookChange::Level(0)) == BookChange::NONE)
+    {
+        return changes;
+    }
+
+    const Instrument instrument = book.GetInstrument();
+    const TopLevels& levels = mBooks.GetLevels(instrument);
+    if (levels.AskPrices()[0] == 0 || levels.BidPrices()[0] == 0)
+    {
+        return changes;
+    }
+
+    TopOfBook& top = mTops[static_cast<std::size_t>(instrument)];
+    top.mAskPrice = levels.AskPrices()[0];
+    top.mAskVolume = levels.AskVolumes()[0];
+    top.mBidPrice = levels.BidPrices()[0];
+    top.mBidVolume = levels.BidVolumes()[0];
+    top.mIsMicropriceStale = true;
+    if (changes & BookChange::BEST_PRICES)
+    {
+        top.mIsMidpointStale = true;
+        mIsRatioStale = true;
+    }
+    return changes;
+}
+
+void MarketState::OnTradeTicks(const TradeTicksMessage& ticks) noexcept
+{
+    mTradeTicks[static_cast<std::size_t>(ticks.mInstrument)] = ticks;
+}
+
+FixedPrice MarketState::GetMidpoint(Instrument instrument) const noexcept
+{
+    const TopOfBook& top = Top(instrument);
+    if (top.mIsMidpointStale)
+    {
+        top.mMidpoint = FixedPrice::FromQuotient(static_cast<std::int64_t>(top.mAskPrice + top.mBidPrice), 2);
+        top.mIsMidpointStale = false;
+    }
+    return top.mMidpoint;
+}
+
+FixedPrice MarketState::GetMicroprice(Instrument instrument) const noexcept
+{
+    const TopOfBook& top = Top(instrument);
+    if (top.mIsMicropriceStale)
+    {
+        top.mMicroprice = FixedPrice::FromQuotient(
+            static_cast<std::int64_t>(top.mBidPrice * top.mAskVolume + top.mAskPrice * top.mBidVolume),
+            static_cast<std::int64_t>(top.mAskVolume + top.mBidVolume));
+        top.mIsMicropriceStale = false;
+    }
+    return top.mMicroprice;
+}
+
+FixedRatio MarketState::GetRatio() const noexcept
+{
+    if (mIsRatioStale && HasRatio())
+    {
+        // The ratio of the midpoints is the ratio of the sums of the best
+        // prices, which avoids rounding the midpoints first.
+        const TopOfBook& etf = Top(Instrument::ETF);
+        const TopOfBook& future = Top(Instrument::FUTURE);
+        mRatio = FixedRatio::FromQuotient(static_cast<std::int64_t>(etf.mAskPrice + etf.mBidPrice),
+                                          static_cast<std::int64_t>(future.mAskPrice + future.mBidPrice));
+        mIsRatioStale = false;
+    }
+    return mRatio;
+}
+
+}
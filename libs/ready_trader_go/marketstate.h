@@ -0,0 +1,101 @@
+// Copyright 2021 Optiver Asia Pacific Pty. Ltd.
+//
+// This file is part of Ready Trader Go.
+//
+//     Ready Trader Go is free software: you can redistribute it and/or
+//     modify it under the terms of the GNU Affero General Public License
+//     as published by the Free Software Foundation, either version 3 of
+//     the License, or (at your option) any later version.
+//
+//     Ready Trader Go is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU Affero General Public License for more details.
+//
+//     You should have received a copy of the GNU Affero General Public
+//     License along with Ready Trader Go.  If not, see
+//     <https://www.gnu.org/licenses/>.
+#ifndef CPPREADY_TRADER_GO_LIBS_READY_TRADER_GO_MARKETSTATE_H
+#define CPPREADY_TRADER_GO_LIBS_READY_TRADER_GO_MARKETSTATE_H
+
+#include <array>
+#include <cstddef>
+
+#include "bookcache.h"
+#include "fixedpoint.h"
+#include "protocol.h"
+#include "types.h"
+
+namespace ReadyTraderGo {
+
+// The state of both instruments' markets as seen by a pair strategy: the
+// latest order books, the latest trade ticks and values derived from the
+// best levels of each book.
+//
+// The derived values are computed when first read after the best levels
+// they depend on change, so an update that leaves the top of the book alone
+// costs nothing beyond the book comparison and a value read twice is only
+// computed once. A side of a book with no orders leaves the derived values
+// at those of the last book in which both sides had orders. Derived values
+// are fixed-point numbers computed from the integer prices and volumes, so
+// they are exact to the last bit and identical in live trading and in
+// backtests.
+class MarketState
+{
+public:
+    BookChanges OnOrderBook(const OrderBookView& book) noexcept;
+    void OnTradeTicks(const TradeTicksMessage& ticks) noexcept;
+
+    const BookCache& GetBooks() const noexcept { return mBooks; }
+    const TradeTicksMessage& GetTradeTicks(Instrument instrument) const noexcept
+    {
+        return mTradeTicks[static_cast<std::size_t>(instrument)];
+    }
+
+    // Best prices and volumes of the last book in which both sides had
+    // orders, or zero if there has been no such book.
+    unsigned long GetBestAsk(Instrument instrument) const noexcept { return Top(instrument).mAskPrice; }
+    unsigned long GetBestBid(Instrument instrument) const noexcept { return Top(instrument).mBidPrice; }
+
+    // True once a book with orders on both sides has been received.
+    bool HasPrices(Instrument instrument) const noexcept { return Top(instrument).mAskPrice != 0; }
+    bool HasRatio() const noexcept { return HasPrices(Instrument::ETF) && HasPrices(Instrument::FUTURE); }
+
+    // Halfway between the best bid and ask prices.
+    FixedPrice GetMidpoint(Instrument instrument) const noexcept;
+    // The best prices weighted by the volume on the opposite side, which
+    // leans towards the side more likely to trade next.
+    FixedPrice GetMicroprice(Instrument instrument) const noexcept;
+    // The ETF's midpoint divided by the future's.
+    FixedRatio GetRatio() const noexcept;
+
+private:
+    struct TopOfBook
+    {
+        unsigned long mAskPrice = 0;
+        unsigned long mAskVolume = 0;
+        unsigned long mBidPrice = 0;
+        unsigned long mBidVolume = 0;
+
+        mutable FixedPrice mMidpoint;
+        mutable FixedPrice mMicroprice;
+        mutable bool mIsMidpointStale = false;
+        mutable bool mIsMicropriceStale = false;
+    };
+
+    const TopOfBook& Top(Instrument instrument) const noexcept
+    {
+        return mTops[static_cast<std::size_t>(instrument)];
+    }
+
+    BookCache mBooks;
+    std::array<TopOfBook, 2> mTops;
+    std::array<TradeTicksMessage, 2> mTradeTicks;
+
+    mutable FixedRatio mRatio;
+    mutable bool mIsRatioStale = false;
+};
+
+}
+
+#endif //CPPREADY_TRADER_GO_LIBS_READY_TRADER_GO_MARKETSTATE_H
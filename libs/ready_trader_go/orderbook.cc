@@ -0,0 +1,291 @@
+// Copyright 2021 Optiver Asia Pacific Pty. Ltd.
+//
+// This file is part of Ready Trader Go.
+//
+//     Ready Trader Go is free software: you can redistribute it and/or
+//     modify it under the terms of the GNU Affero General Public License
+//     as published by the Free Software Foundation, either version 3 of
+//     the License, or (at your option) any later version.
+//
+//     Ready Trader Go is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU Affero General Public License for more details.
+//
+//     You should have received a copy of the GNU Affero General Public
+//     License along with Ready Trader Go.  If not, see
+//     <https://www.gnu.org/licenses/>.
+#include <cmath>
+
+#include "orderbook.h"
+
+namespace ReadyTraderGo {
+
+namespace {
+
+// Populate prices and volumes from up to TOP_LEVEL_COUNT entries of a price
+// to volume map, padding any remaining levels with zeros.
+template<typename Map, typename Projection>
+void fillLevels(const Map& map, PriceLevels& prices, PriceLevels& volumes, Projection volumeOf)
+{
+    std::size_t i = 0;
+    for (auto it = map.begin(); i < TOP_LEVEL_COUNT && it != map.end(); ++it, ++i)
+    {
+        prices[i] = it->first;
+        volumes[i] = volumeOf(it->second);
+    }
+    for (; i < TOP_LEVEL_COUNT; ++i)
+    {
+        prices[i] = volumes[i] = 0;
+    }
+}
+
+long roundFee(unsigned long price, unsigned long volume, double rate)
+{
+    // Python's round() rounds half to even, which nearbyint does in the
+    // default rounding mode.
+    return static_cast<long>(std::nearbyint(static_cast<double>(price) * static_cast<double>(volume) * rate));
+}
+
+}
+
+void OrderBook::Amend(double now, Order& order, unsigned long newVolume)
+{
+    if (order.mRemainingVolume > 0)
+    {
+        unsigned long fillVolume = order.mVolume - order.mRemainingVolume;
+        unsigned long diff = order.mVolume - ((newVolume < fillVolume) ? fillVolume : newVolume);
+        RemoveVolumeFromLevel(order.mPrice, diff, order.mSide);
+        order.mVolume -= diff;
+        order.mRemainingVolume -= diff;
+        if (order.mListener)
+        {
+            order.mListener->OnOrderAmended(now, order, diff);
+        }
+    }
+}
+
+void OrderBook::Cancel(double now, Order& order)
+{
+    if (order.mRemainingVolume > 0)
+    {
+        RemoveVolumeFromLevel(order.mPrice, order.mRemainingVolume, order.mSide);
+        unsigned long remaining = order.mRemainingVolume;
+        order.mRemainingVolume = 0;
+        if (order.mListener)
+        {
+            order.mListener->OnOrderCancelled(now, order, remaining);
+        }
+    }
+}
+
+void OrderBook::Insert(double now, const std::shared_ptr<Order>& order)
+{
+    if (order->mSide == Side::SELL && !mBids.empty() && order->mPrice <= mBids.begin()->first)
+    {
+        Trade(now, *order, mBids, mBidTicks);
+    }
+    else if (order->mSide == Side::BUY && !mAsks.empty() && order->mPrice >= mAsks.begin()->first)
+    {
+        Trade(now, *order, mAsks, mAskTicks);
+    }
+
+    if (order->mRemainingVolume > 0)
+    {
+        if (order->mLifespan == Lifespan::FILL_AND_KILL)
+        {
+            unsigned long remaining = order->mRemainingVolume;
+            order->mRemainingVolume = 0;
+            if (order->mListener)
+            {
+                order->mListener->OnOrderCancelled(now, *order, remaining);
+            }
+        }
+        else
+        {
+            Place(now, order);
+        }
+    }
+}
+
+double OrderBook::GetMidpointPrice() const noexcept
+{
+    if (mBids.empty() || mAsks.empty())
+    {
+        return 0.0;
+    }
+    return static_cast<double>(mBids.begin()->first + mAsks.begin()->first) / 2.0;
+}
+
+void OrderBook::Place(double now, const std::shared_ptr<Order>& order)
+{
+    Level& level = (order->mSide == Side::SELL) ? mAsks[order->mPrice] : mBids[order->mPrice];
+    level.mOrders.push_back(order);
+    level.mTotalVolume += order->mRemainingVolume;
+
+    if (order->mListener)
+    {
+        order->mListener->OnOrderPlaced(now, *order);
+    }
+}
+
+void OrderBook::RemoveVolumeFromLevel(unsigned long price, unsigned long volume, Side side)
+{
+    auto remove = [price, volume](auto& levels)
+    {
+        auto it = levels.find(price);
+        if (it == levels.end())
+        {
+            return;
+        }
+        if (it->second.mTotalVolume == volume)
+        {
+            levels.erase(it);
+        }
+        else
+        {
+            it->second.mTotalVolume -= volume;
+        }
+    };
+
+    if (side == Side::SELL)
+    {
+        remove(mAsks);
+    }
+    else
+    {
+        remove(mBids);
+    }
+}
+
+void OrderBook::TopLevels(PriceLevels& askPrices,
+                          PriceLevels& askVolumes,
+                          PriceLevels& bidPrices,
+                          PriceLevels& bidVolumes) const
+{
+    auto totalVolume = [](const Level& level) { return level.mTotalVolume; };
+    fillLevels(mAsks, askPrices, askVolumes, totalVolume);
+    fillLevels(mBids, bidPrices, bidVolumes, totalVolume);
+}
+
+template<typename Levels, typename Ticks>
+void OrderBook::Trade(double now, Order& order, Levels& levels, Ticks& ticks)
+{
+    // Levels are ordered best first, so the comparator tells us whether the
+    // best level is at or better than the order's limit price.
+    auto isMarketable = [&levels, &order](unsigned long price)
+    {
+        return !levels.key_comp()(order.mPrice, price);
+    };
+
+    auto best = levels.begin();
+    while (order.mRemainingVolume > 0 && isMarketable(best->first) && best->second.mTotalVolume > 0)
+    {
+        TradeLevel(now, order, best->first, best->second, ticks[best->first]);
+        if (best->second.mTotalVolume == 0)
+        {
+            best = levels.erase(best);
+            if (best == levels.end())
+            {
+                break;
+            }
+        }
+    }
+}
+
+void OrderBook::TradeLevel(double now, Order& order, unsigned long price, Level& level, unsigned long& ticks)
+{
+    unsigned long remaining = order.mRemainingVolume;
+    unsigned long totalVolume = level.mTotalVolume;
+
+    while (remaining > 0 && totalVolume > 0)
+    {
+        while (level.mOrders.front()->mRemainingVolume == 0)
+        {
+            level.mOrders.pop_front();
+        }
+        Order& passive = *level.mOrders.front();
+        unsigned long volume = (remaining < passive.mRemainingVolume) ? remaining : passive.mRemainingVolume;
+        long fee = roundFee(price, volume, mMakerFee);
+        totalVolume -= volume;
+        remaining -= volume;
+        passive.mRemainingVolume -= volume;
+        passive.mTotalFees += fee;
+        if (passive.mListener)
+        {
+            passive.mListener->OnOrderFilled(now, passive, price, volume, fee);
+        }
+    }
+
+    level.mTotalVolume = totalVolume;
+    unsigned long tradedVolume = order.mRemainingVolume - remaining;
+    ticks += tradedVolume;
+
+    long fee = roundFee(price, tradedVolume, mTakerFee);
+    order.mRemainingVolume = remaining;
+    order.mTotalFees += fee;
+    if (order.mListener)
+    {
+        order.mListener->OnOrderFilled(now, order, price, tradedVolume, fee);
+    }
+
+    mLastTradedPrice = price;
+    if (TradeOccurred)
+    {
+        TradeOccurred(*this);
+    }
+}
+
+bool OrderBook::TradeTicks(PriceLevels& askPrices,
+                           PriceLevels& askVolumes,
+                           PriceLevels& bidPrices,
+                           PriceLevels& bidVolumes)
+{
+    if (mAskTicks.empty() && mBidTicks.empty())
+    {
+        return false;
+    }
+
+    auto volume = [](unsigned long v) { return v; };
+    fillLevels(mAskTicks, askPrices, askVolumes, volume);
+    fillLevels(mBidTicks, bidPrices, bidVolumes, volume);
+    mAskTicks.clear();
+    mBidTicks.clear();
+    return true;
+}
+
+std::pair<unsigned long, unsigned long> OrderBook::TryTrade(Side side,
+                                                            unsigned long limitPrice,
+                                                            unsigned long volume) const
+{
+    unsigned long totalVolume = 0;
+    unsigned long totalValue = 0;
+
+    auto walk = [&](const auto& levels, auto isMarketable)
+    {
+        for (auto it = levels.begin(); totalVolume < volume && it != levels.end(); ++it)
+        {
+            if (it->first == 0 || !isMarketable(it->first))
+            {
+                break;
+            }
+            unsigned long required = volume - totalVolume;
+            unsigned long weight = (required <= it->second.mTotalVolume) ? required : it->second.mTotalVolume;
+            totalVolume += weight;
+            totalValue += weight * it->first;
+        }
+    };
+
+    if (side == Side::SELL)
+    {
+        walk(mBids, [limitPrice](unsigned long price) { return price >= limitPrice; });
+    }
+    else
+    {
+        walk(mAsks, [limitPrice](unsigned long price) { return price <= limitPrice; });
+    }
+
+    return {totalVolume, (totalVolume > 0) ? totalValue / totalVolume : 0};
+}
+
+}
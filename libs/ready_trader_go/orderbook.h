@@ -0,0 +1,153 @@
+// Copyright 2021 Optiver Asia Pacific Pty. Ltd.
+//
+// This file is part of Ready Trader Go.
+//
+//     Ready Trader Go is free software: you can redistribute it and/or
+//     modify it under the terms of the GNU Affero General Public License
+//     as published by the Free Software Foundation, either version 3 of
+//     the License, or (at your option) any later version.
+//
+//     Ready Trader Go is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU Affero General Public License for more details.
+//
+//     You should have received a copy of the GNU Affero General Public
+//     License along with Ready Trader Go.  If not, see
+//     <https://www.gnu.org/licenses/>.
+#ifndef CPPREADY_TRADER_GO_LIBS_READY_TRADER_GO_ORDERBOOK_H
+#define CPPREADY_TRADER_GO_LIBS_READY_TRADER_GO_ORDERBOOK_H
+
+#include <array>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <utility>
+
+#include "types.h"
+
+namespace ReadyTraderGo {
+
+struct Order;
+
+struct IOrderListener
+{
+    virtual ~IOrderListener() = default;
+
+    // Called when the order is amended.
+    virtual void OnOrderAmended(double now, Order& order, unsigned long volumeRemoved) {}
+
+    // Called when the order is cancelled.
+    virtual void OnOrderCancelled(double now, Order& order, unsigned long volumeRemoved) {}
+
+    // Called when a good-for-day order is placed in the order book.
+    virtual void OnOrderPlaced(double now, Order& order) {}
+
+    // Called when the order is partially or completely filled.
+    virtual void OnOrderFilled(double now, Order& order, unsigned long price, unsigned long volume, long fee) {}
+};
+
+// A request to buy or sell at a given price.
+struct Order
+{
+    Order(unsigned long clientOrderId,
+          Instrument instrument,
+          Lifespan lifespan,
+          Side side,
+          unsigned long price,
+          unsigned long volume,
+          IOrderListener* listener = nullptr)
+        : mClientOrderId(clientOrderId),
+          mInstrument(instrument),
+          mLifespan(lifespan),
+          mSide(side),
+          mPrice(price),
+          mRemainingVolume(volume),
+          mVolume(volume),
+          mListener(listener) {}
+
+    unsigned long mClientOrderId;
+    Instrument mInstrument;
+    Lifespan mLifespan;
+    Side mSide;
+    unsigned long mPrice;
+    unsigned long mRemainingVolume;
+    long mTotalFees = 0;
+    unsigned long mVolume;
+    IOrderListener* mListener;
+};
+
+using PriceLevels = std::array<unsigned long, TOP_LEVEL_COUNT>;
+
+// A collection of orders arranged by the price-time priority principle. This
+// is a port of the matching engine's order_book.py for use in simulations.
+class OrderBook
+{
+public:
+    OrderBook(Instrument instrument, double makerFee, double takerFee)
+        : mInstrument(instrument), mMakerFee(makerFee), mTakerFee(takerFee) {}
+
+    Instrument GetInstrument() const noexcept { return mInstrument; }
+
+    // Amend an order in this order book by decreasing its volume.
+    void Amend(double now, Order& order, unsigned long newVolume);
+
+    // Cancel an order in this order book.
+    void Cancel(double now, Order& order);
+
+    // Insert a new order into this order book.
+    void Insert(double now, const std::shared_ptr<Order>& order);
+
+    // Return the last traded price, or zero if there have been no trades.
+    unsigned long GetLastTradedPrice() const noexcept { return mLastTradedPrice; }
+
+    // Return the midpoint price, or zero if either side of the book is empty.
+    double GetMidpointPrice() const noexcept;
+
+    // Populate the supplied arrays with the top levels for this book.
+    void TopLevels(PriceLevels& askPrices,
+                   PriceLevels& askVolumes,
+                   PriceLevels& bidPrices,
+                   PriceLevels& bidVolumes) const;
+
+    // Populate the supplied arrays and return true if there have been trades
+    // since the last call.
+    bool TradeTicks(PriceLevels& askPrices,
+                    PriceLevels& askVolumes,
+                    PriceLevels& bidPrices,
+                    PriceLevels& bidVolumes);
+
+    // Return the volume that would trade and the average price per lot for
+    // the requested trade without changing the order book.
+    std::pair<unsigned long, unsigned long> TryTrade(Side side, unsigned long limitPrice, unsigned long volume) const;
+
+    std::function<void(OrderBook&)> TradeOccurred;
+
+private:
+    struct Level
+    {
+        std::deque<std::shared_ptr<Order>> mOrders;
+        unsigned long mTotalVolume = 0;
+    };
+
+    void Place(double now, const std::shared_ptr<Order>& order);
+    void RemoveVolumeFromLevel(unsigned long price, unsigned long volume, Side side);
+    template<typename Levels, typename Ticks>
+    void Trade(double now, Order& order, Levels& levels, Ticks& ticks);
+    void TradeLevel(double now, Order& order, unsigned long price, Level& level, unsigned long& ticks);
+
+    Instrument mInstrument;
+    double mMakerFee;
+    double mTakerFee;
+
+    std::map<unsigned long, Level> mAsks;
+    std::map<unsigned long, Level, std::greater<>> mBids;
+    std::map<unsigned long, unsigned long> mAskTicks;
+    std::map<unsigned long, unsigned long, std::greater<>> mBidTicks;
+    unsigned long mLastTradedPrice = 0;
+};
+
+}
+
+#endif //CPPREADY_TRADER_GO_LIBS_READY_TRADER_GO_ORDERBOOK_H
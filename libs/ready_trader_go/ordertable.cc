@@ -0,0 +1,87 @@
+// Copyright 2021 Optiver Asia Pacific Pty. Ltd.
+//
+// This file is part of Ready Trader Go.
+//
+//     Ready Trader Go is free software: you can redistribute it and/or
+//     modify it under the terms of the GNU Affero General Public License
+//     as published by the Free Software Foundation, either version 3 of
+//     the License, or (at your option) any later version.
+//
+//     Ready Trader Go is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU Affero General Public License for more details.
+//
+//     You should have received a copy of the GNU Affero General Public
+//     License along with Ready Trader Go.  If not, see
+//     <https://www.gnu.org/licenses/>.
+#include "error.h"
+#include "ordertable.h"
+
+namespace ReadyTraderGo {
+
+static_assert((ORDER_TABLE_CAPACITY & (ORDER_TABLE_CAPACITY - 1)) == 0,
+              "order table capacity must be a power of two");
+
+TrackedOrder& OrderTable::Insert(unsigned long clientOrderId,
+                                 Side side,
+                                 unsigned long price,
+                                 unsigned long volume)
+{
+    if (clientOrderId == 0)
+    {
+        throw ReadyTraderGoError("client order id must not be zero");
+    }
+
+    // Leave at least one empty slot so that probing always terminates.
+    if (mCount == ORDER_TABLE_CAPACITY - 1)
+    {
+        throw ReadyTraderGoError("order table is full");
+    }
+
+    std::size_t i = HomeSlot(clientOrderId);
+    while (mSlots[i].mClientOrderId != 0)
+    {
+        if (mSlots[i].mClientOrderId == clientOrderId)
+        {
+            throw ReadyTraderGoError("client order id is already in use");
+        }
+        i = (i + 1) & (ORDER_TABLE_CAPACITY - 1);
+    }
+
+    TrackedOrder& order = mSlots[i];
+    order = TrackedOrder{clientOrderId, price, 0, side, OrderState::PENDING};
+    SetRemainingVolume(order, volume);
+    ++mCount;
+    return order;
+}
+
+bool OrderTable::Erase(unsigned long clientOrderId) noexcept
+{
+    TrackedOrder* order = Find(clientOrderId);
+    if (order == nullptr)
+    {
+        return false;
+    }
+
+    SetRemainingVolume(*order, 0);
+    --mCount;
+
+    // Shift back any later entry in the same run whose home slot is not
+    // between the gap and its current slot, so probes never stop early.
+    constexpr std::size_t mask = ORDER_TABLE_CAPACITY - 1;
+    std::size_t gap = static_cast<std::size_t>(order - mSlots.data());
+    for (std::size_t i = (gap + 1) & mask; mSlots[i].mClientOrderId != 0; i = (i + 1) & mask)
+    {
+        std::size_t home = HomeSlot(mSlots[i].mClientOrderId);
+        if (((i - home) & mask) >= ((i - gap) & mask))
+        {
+            mSlots[gap] = mSlots[i];
+            gap = i;
+        }
+    }
+    mSlots[gap] = TrackedOrder{};
+    return true;
+}
+
+}
@@ -0,0 +1,130 @@
+// Copyright 2021 Optiver Asia Pacific Pty. Ltd.
+//
+// This file is part of Ready Trader Go.
+//
+//     Ready Trader Go is free software: you can redistribute it and/or
+//     modify it under the terms of the GNU Affero General Public License
+//     as published by the Free Software Foundation, either version 3 of
+//     the License, or (at your option) any later version.
+//
+//     Ready Trader Go is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU Affero General Public License for more details.
+//
+//     You should have received a copy of the GNU Affero General Public
+//     License along with Ready Trader Go.  If not, see
+//     <https://www.gnu.org/licenses/>.
+#ifndef CPPREADY_TRADER_GO_LIBS_READY_TRADER_GO_ORDERTABLE_H
+#define CPPREADY_TRADER_GO_LIBS_READY_TRADER_GO_ORDERTABLE_H
+
+#include <array>
+#include <cstddef>
+
+#include "types.h"
+
+namespace ReadyTraderGo {
+
+// Number of slots in an order table, which bounds the number of orders that
+// may be tracked at once. Must be a power of two.
+constexpr std::size_t ORDER_TABLE_CAPACITY = 256;
+
+enum class OrderState : unsigned char
+{
+    PENDING,  // sent but not yet acknowledged by the exchange
+    LIVE      // acknowledged by an order status message
+};
+
+struct TrackedOrder
+{
+    unsigned long mClientOrderId = 0;  // zero marks an empty slot
+    unsigned long mPrice = 0;
+    unsigned long mRemainingVolume = 0;
+    Side mSide = Side::SELL;
+    OrderState mState = OrderState::PENDING;
+};
+
+// The state of an auto-trader's outstanding orders, keyed by client order id.
+//
+// Orders are held in a fixed array using open addressing with linear probing
+// and removed by shifting later entries back, so no operation allocates.
+// Client order ids are issued in increasing order, so an order's home slot
+// is rarely taken and lookups usually touch a single slot. The total count
+// and the remaining volume on each side are kept up to date as orders change.
+class OrderTable
+{
+public:
+    // Start tracking an order. Throws if the table is full.
+    TrackedOrder& Insert(unsigned long clientOrderId, Side side, unsigned long price, unsigned long volume);
+
+    // Return the order with the given id or nullptr if it is not tracked.
+    TrackedOrder* Find(unsigned long clientOrderId) noexcept;
+
+    // Reduce an order's remaining volume by a filled volume.
+    void Fill(TrackedOrder& order, unsigned long volume) noexcept;
+
+    // Set an order's remaining volume from an order status message.
+    void Update(TrackedOrder& order, unsigned long remainingVolume) noexcept;
+
+    // Stop tracking an order. Returns false if the order was not tracked.
+    bool Erase(unsigned long clientOrderId) noexcept;
+
+    // Number of orders being tracked.
+    std::size_t GetCount() const noexcept { return mCount; }
+
+    // Total remaining volume of the tracked orders on one side.
+    unsigned long GetVolume(Side side) const noexcept { return mVolumes[static_cast<int>(side)]; }
+
+private:
+    static std::size_t HomeSlot(unsigned long clientOrderId) noexcept
+    {
+        return clientOrderId & (ORDER_TABLE_CAPACITY - 1);
+    }
+
+    void SetRemainingVolume(TrackedOrder& order, unsigned long volume) noexcept
+    {
+        unsigned long& total = mVolumes[static_cast<int>(order.mSide)];
+        total = total - order.mRemainingVolume + volume;
+        order.mRemainingVolume = volume;
+    }
+
+    std::array<TrackedOrder, ORDER_TABLE_CAPACITY> mSlots{};
+    std::array<unsigned long, 2> mVolumes{};
+    std::size_t mCount = 0;
+};
+
+inline TrackedOrder* OrderTable::Find(unsigned long clientOrderId) noexcept
+{
+    if (clientOrderId == 0)
+    {
+        return nullptr;
+    }
+
+    for (std::size_t i = HomeSlot(clientOrderId);; i = (i + 1) & (ORDER_TABLE_CAPACITY - 1))
+    {
+        TrackedOrder& slot = mSlots[i];
+        if (slot.mClientOrderId == clientOrderId)
+        {
+            return &slot;
+        }
+        if (slot.mClientOrderId == 0)
+        {
+            return nullptr;
+        }
+    }
+}
+
+inline void OrderTable::Fill(TrackedOrder& order, unsigned long volume) noexcept
+{
+    SetRemainingVolume(order, (volume < order.mRemainingVolume) ? order.mRemainingVolume - volume : 0);
+}
+
+inline void OrderTable::Update(TrackedOrder& order, unsigned long remainingVolume) noexcept
+{
+    SetRemainingVolume(order, remainingVolume);
+    order.mState = OrderState::LIVE;
+}
+
+}
+
+#endif //CPPREADY_TRADER_GO_LIBS_READY_TRADER_GO_ORDERTABLE_H
@@ -20,10 +20,56 @@
 
 #include <boost/endian/conversion.hpp>
 
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSSE3__)
+#include <tmmintrin.h>
+#endif
+
 #include "protocol.h"
 
 namespace ReadyTraderGo {
 
+void DecodeTopLevels(unsigned char const* data, TopLevels& levels) noexcept
+{
+    static_assert(TopLevels::FIELD_COUNT == 20, "SIMD decode assumes twenty fields");
+    auto* out = levels.mFields.data();
+
+#if defined(__AVX2__) || defined(__SSSE3__)
+    // Reverse the bytes of each 32-bit lane.
+    const __m128i swap128 = _mm_setr_epi8(3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12);
+#endif
+#if defined(__AVX2__)
+    const __m256i swap256 = _mm256_broadcastsi128_si256(swap128);
+    const __m256i a = _mm256_loadu_si256((__m256i const*) data);
+    const __m256i b = _mm256_loadu_si256((__m256i const*)(data + 32));
+    const __m128i c = _mm_loadu_si128((__m128i const*)(data + 64));
+    _mm256_store_si256((__m256i*) out, _mm256_shuffle_epi8(a, swap256));
+    _mm256_store_si256((__m256i*)(out + 8), _mm256_shuffle_epi8(b, swap256));
+    _mm_store_si128((__m128i*)(out + 16), _mm_shuffle_epi8(c, swap128));
+#elif defined(__SSSE3__)
+    for (std::size_t i = 0; i < TopLevels::FIELD_COUNT; i += 4)
+    {
+        const __m128i v = _mm_loadu_si128((__m128i const*)(data + i * MessageFieldSize::LONG));
+        _mm_store_si128((__m128i*)(out + i), _mm_shuffle_epi8(v, swap128));
+    }
+#else
+    for (std::size_t i = 0; i < TopLevels::FIELD_COUNT; ++i)
+    {
+        out[i] = boost::endian::load_big_u32(data + i * MessageFieldSize::LONG);
+    }
+#endif
+}
+
+template<std::size_t N>
+static inline void widen(std::array<unsigned long, N>& to, uint32_t const* from)
+{
+    for (std::size_t i = 0; i < N; ++i)
+    {
+        to[i] = from[i];
+    }
+}
+
 static std::string readFixedLengthString(unsigned char const* data, std::size_t maxSize)
 {
     auto loc = (decltype(data)) std::memchr(data, 0, maxSize);
@@ -166,26 +212,12 @@ void OrderBookMessage::Deserialise(unsigned char const* data, std::size_t)
     mSequenceNumber = boost::endian::big_to_native(*(uint32_t*)data);
     data += MessageFieldSize::LONG;
 
-    for (auto& p : mAskPrices)
-    {
-        p = boost::endian::big_to_native(*(uint32_t*)data);
-        data += MessageFieldSize::LONG;
-    }
-    for (auto& v : mAskVolumes)
-    {
-        v = boost::endian::big_to_native(*(uint32_t*)data);
-        data += MessageFieldSize::LONG;
-    }
-    for (auto& p : mBidPrices)
-    {
-        p = boost::endian::big_to_native(*(uint32_t*)data);
-        data += MessageFieldSize::LONG;
-    }
-    for (auto& v : mBidVolumes)
-    {
-        v = boost::endian::big_to_native(*(uint32_t*)data);
-        data += MessageFieldSize::LONG;
-    }
+    TopLevels levels;
+    DecodeTopLevels(data, levels);
+    widen(mAskPrices, levels.AskPrices());
+    widen(mAskVolumes, levels.AskVolumes());
+    widen(mBidPrices, levels.BidPrices());
+    widen(mBidVolumes, levels.BidVolumes());
 }
 
 void OrderBookMessage::Serialise(unsigned char* buf) const
@@ -264,26 +296,12 @@ void TradeTicksMessage::Deserialise(unsigned char const* data, std::size_t)
     mSequenceNumber = boost::endian::big_to_native(*(uint32_t*)data);
     data += MessageFieldSize::LONG;
 
-    for (auto& p : mAskPrices)
-    {
-        p = boost::endian::big_to_native(*(uint32_t*)data);
-        data += MessageFieldSize::LONG;
-    }
-    for (auto& v : mAskVolumes)
-    {
-        v = boost::endian::big_to_native(*(uint32_t*)data);
-        data += MessageFieldSize::LONG;
-    }
-    for (auto& p : mBidPrices)
-    {
-        p = boost::endian::big_to_native(*(uint32_t*)data);
-        data += MessageFieldSize::LONG;
-    }
-    for (auto& v : mBidVolumes)
-    {
-        v = boost::endian::big_to_native(*(uint32_t*)data);
-        data += MessageFieldSize::LONG;
-    }
+    TopLevels levels;
+    DecodeTopLevels(data, levels);
+    widen(mAskPrices, levels.AskPrices());
+    widen(mAskVolumes, levels.AskVolumes());
+    widen(mBidPrices, levels.BidPrices());
+    widen(mBidVolumes, levels.BidVolumes());
 }
 
 void TradeTicksMessage::Serialise(unsigned char* buf) const
@@ -20,10 +20,13 @@
 
 #include <array>
 #include <cstddef>
+#include <cstdint>
 #include <string>
 #include <utility>
 #include <vector>
 
+#include <boost/endian/conversion.hpp>
+
 #include "connectivitytypes.h"
 #include "types.h"
 
@@ -120,6 +123,49 @@ struct HedgeMessage : ISerialisable
     unsigned long mVolume = 0;
 };
 
+// A hedge message encoded once, header included, for one side. Encoding a
+// hedge patches only the client order id and volume in place; the price is
+// rewritten only when it changes.
+class HedgeMessageTemplate
+{
+public:
+    static constexpr std::size_t SIZE = MESSAGE_HEADER_SIZE + MessageFieldSize::LONG * 3 + MessageFieldSize::BYTE;
+
+    explicit HedgeMessageTemplate(Side side) noexcept
+    {
+        *(uint16_t*)mData.data() = boost::endian::native_to_big((uint16_t)SIZE);
+        mData[MESSAGE_TYPE_OFFSET] = MessageType::HEDGE_ORDER;
+        mData[SIDE_OFFSET] = static_cast<unsigned char>(side);
+        SetPrice(0);
+    }
+
+    unsigned char const* Encode(unsigned long clientOrderId, unsigned long price, unsigned long volume) noexcept
+    {
+        *(uint32_t*)(mData.data() + CLIENT_ORDER_ID_OFFSET) = boost::endian::native_to_big((uint32_t)clientOrderId);
+        if (price != mPrice)
+        {
+            SetPrice(price);
+        }
+        *(uint32_t*)(mData.data() + VOLUME_OFFSET) = boost::endian::native_to_big((uint32_t)volume);
+        return mData.data();
+    }
+
+private:
+    static constexpr std::size_t CLIENT_ORDER_ID_OFFSET = MESSAGE_HEADER_SIZE;
+    static constexpr std::size_t SIDE_OFFSET = CLIENT_ORDER_ID_OFFSET + MessageFieldSize::LONG;
+    static constexpr std::size_t PRICE_OFFSET = SIDE_OFFSET + MessageFieldSize::BYTE;
+    static constexpr std::size_t VOLUME_OFFSET = PRICE_OFFSET + MessageFieldSize::LONG;
+
+    void SetPrice(unsigned long price) noexcept
+    {
+        *(uint32_t*)(mData.data() + PRICE_OFFSET) = boost::endian::native_to_big((uint32_t)price);
+        mPrice = price;
+    }
+
+    std::array<unsigned char, SIZE> mData;
+    unsigned long mPrice = 0;
+};
+
 struct HedgeFilledMessage : ISerialisable
 {
     HedgeFilledMessage() = default;
@@ -184,6 +230,26 @@ struct LoginMessage : ISerialisable
     std::string mSecret;
 };
 
+// The prices and volumes reported in an order book or trade ticks message,
+// converted to native byte order and packed into cache-line-aligned storage
+// in wire order: ask prices, ask volumes, bid prices and bid volumes.
+struct alignas(CACHE_LINE_SIZE) TopLevels
+{
+    static constexpr std::size_t FIELD_COUNT = TOP_LEVEL_COUNT * 4;
+
+    uint32_t const* AskPrices() const noexcept { return mFields.data(); }
+    uint32_t const* AskVolumes() const noexcept { return mFields.data() + TOP_LEVEL_COUNT; }
+    uint32_t const* BidPrices() const noexcept { return mFields.data() + TOP_LEVEL_COUNT * 2; }
+    uint32_t const* BidVolumes() const noexcept { return mFields.data() + TOP_LEVEL_COUNT * 3; }
+
+    std::array<uint32_t, FIELD_COUNT> mFields;
+};
+
+// Byte-swap the price and volume fields starting at data into levels. Uses
+// AVX2 or SSSE3 shuffles when the build targets them and a scalar loop
+// otherwise.
+void DecodeTopLevels(unsigned char const* data, TopLevels& levels) noexcept;
+
 struct OrderBookMessage : ISerialisable
 {
     OrderBookMessage() = default;
@@ -218,6 +284,73 @@ struct OrderBookMessage : ISerialisable
     std::array<unsigned long, TOP_LEVEL_COUNT> mBidVolumes = {};
 };
 
+// A view of the prices or volumes at the top levels of one side of a book
+// which decodes each level from the message bytes when it is accessed.
+class PriceLevelsView
+{
+public:
+    explicit PriceLevelsView(unsigned char const* data) noexcept : mData(data) {}
+
+    unsigned long operator[](std::size_t level) const noexcept
+    {
+        return boost::endian::load_big_u32(mData + level * MessageFieldSize::LONG);
+    }
+
+    constexpr std::size_t size() const noexcept { return TOP_LEVEL_COUNT; }
+
+    std::array<unsigned long, TOP_LEVEL_COUNT> ToArray() const noexcept
+    {
+        std::array<unsigned long, TOP_LEVEL_COUNT> result;
+        for (std::size_t i = 0; i < TOP_LEVEL_COUNT; ++i)
+        {
+            result[i] = (*this)[i];
+        }
+        return result;
+    }
+
+private:
+    unsigned char const* mData;
+};
+
+// A zero-copy view of a serialised order book message. Fields are decoded
+// lazily, so a handler only pays for the fields it reads. The view is only
+// valid for as long as the underlying message bytes are.
+class OrderBookView
+{
+public:
+    OrderBookView(unsigned char const* data, std::size_t size) noexcept : mData(data), mSize(size) {}
+
+    Instrument GetInstrument() const noexcept { return Instrument(*mData); }
+    unsigned long GetSequenceNumber() const noexcept
+    {
+        return boost::endian::load_big_u32(mData + MessageFieldSize::BYTE);
+    }
+
+    PriceLevelsView AskPrices() const noexcept { return PriceLevelsView(Levels(0)); }
+    PriceLevelsView AskVolumes() const noexcept { return PriceLevelsView(Levels(1)); }
+    PriceLevelsView BidPrices() const noexcept { return PriceLevelsView(Levels(2)); }
+    PriceLevelsView BidVolumes() const noexcept { return PriceLevelsView(Levels(3)); }
+
+    void DecodeLevels(TopLevels& levels) const noexcept { DecodeTopLevels(Levels(0), levels); }
+
+    OrderBookMessage ToMessage() const
+    {
+        OrderBookMessage message;
+        message.Deserialise(mData, mSize);
+        return message;
+    }
+
+private:
+    unsigned char const* Levels(std::size_t index) const noexcept
+    {
+        return mData + MessageFieldSize::BYTE + MessageFieldSize::LONG
+            + index * MessageFieldSize::LONG * TOP_LEVEL_COUNT;
+    }
+
+    unsigned char const* mData;
+    std::size_t mSize;
+};
+
 struct OrderFilledMessage : ISerialisable
 {
     OrderFilledMessage() = default;
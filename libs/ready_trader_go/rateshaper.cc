@@ -0,0 +1,168 @@
+// Copyright 2021 Optiver Asia Pacific Pty. Ltd.
+//
+// This file is part of Ready Trader Go.
+//
+//     Ready Trader Go is free software: you can redistribute it and/or
+//     modify it under the terms of the GNU Affero General Public License
+//     as published by the Free Software Foundation, either version 3 of
+//     the License, or (at your option) any later version.
+//
+//     Ready Trader Go is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU Affero General Public License for more details.
+//
+//     You should have received a copy of the GNU Affero General Public
+//     License along with Ready Trader Go.  If not, see
+//     <https://www.gnu.org/licenses/>.
+#include <algorithm>
+
+#include "rateshaper.h"
+
+namespace ReadyTraderGo {
+
+constexpr std::size_t NOT_FOUND = RATE_SHAPER_CAPACITY;
+
+std::size_t RateShaper::Find(RequestType type, unsigned long clientOrderId) const noexcept
+{
+    for (std::size_t i = 0; i < mCount; ++i)
+    {
+        if (mRequests[i].mType == type && mRequests[i].mClientOrderId == clientOrderId)
+        {
+            return i;
+        }
+    }
+    return NOT_FOUND;
+}
+
+std::size_t RateShaper::Next() const noexcept
+{
+    std::size_t amend = NOT_FOUND;
+    std::size_t other = NOT_FOUND;
+    for (std::size_t i = 0; i < mCount; ++i)
+    {
+        switch (mRequests[i].mType)
+        {
+        case RequestType::CANCEL:
+            return i;
+        case RequestType::AMEND:
+            amend = std::min(amend, i);
+            break;
+        default:
+            other = std::min(other, i);
+            break;
+        }
+    }
+    return (amend != NOT_FOUND) ? amend : other;
+}
+
+void RateShaper::Remove(std::size_t index) noexcept
+{
+    std::copy(mRequests.begin() + index + 1, mRequests.begin() + mCount, mRequests.begin() + index);
+    --mCount;
+}
+
+bool RateShaper::Cancel(unsigned long clientOrderId) noexcept
+{
+    std::size_t amend = Find(RequestType::AMEND, clientOrderId);
+    if (amend != NOT_FOUND)
+    {
+        Remove(amend);
+    }
+
+    std::size_t insert = Find(RequestType::INSERT, clientOrderId);
+    if (insert != NOT_FOUND)
+    {
+        // The cancel cannot be queued ahead of the insert, so if the order
+        // cannot be recorded the request is refused.
+        if (mUnsentCount == RATE_SHAPER_CAPACITY)
+        {
+            return false;
+        }
+        Remove(insert);
+        mUnsentOrders[mUnsentCount++] = clientOrderId;
+        return true;
+    }
+
+    if (Find(RequestType::CANCEL, clientOrderId) != NOT_FOUND)
+    {
+        return true;
+    }
+
+    if (mCount == RATE_SHAPER_CAPACITY)
+    {
+        return false;
+    }
+    mRequests[mCount++] = QueuedRequest{clientOrderId, 0, 0, RequestType::CANCEL};
+    return true;
+}
+
+bool RateShaper::Push(const QueuedRequest& request) noexcept
+{
+    if (request.mType == RequestType::CANCEL)
+    {
+        return Cancel(request.mClientOrderId);
+    }
+
+    if (request.mType == RequestType::AMEND)
+    {
+        if (request.mVolume == 0)
+        {
+            return Cancel(request.mClientOrderId);
+        }
+
+        std::size_t insert = Find(RequestType::INSERT, request.mClientOrderId);
+        if (insert != NOT_FOUND)
+        {
+            QueuedRequest& queued = mRequests[insert];
+            queued.mVolume = std::min(queued.mVolume, request.mVolume);
+            return true;
+        }
+
+        if (Find(RequestType::CANCEL, request.mClientOrderId) != NOT_FOUND)
+        {
+            return true;
+        }
+
+        std::size_t amend = Find(RequestType::AMEND, request.mClientOrderId);
+        if (amend != NOT_FOUND)
+        {
+            mRequests[amend].mVolume = request.mVolume;
+            return true;
+        }
+    }
+
+    if (mCount == RATE_SHAPER_CAPACITY)
+    {
+        return false;
+    }
+    mRequests[mCount++] = request;
+    return true;
+}
+
+const QueuedRequest* RateShaper::Front() const noexcept
+{
+    std::size_t next = Next();
+    return (next != NOT_FOUND) ? &mRequests[next] : nullptr;
+}
+
+void RateShaper::Pop() noexcept
+{
+    std::size_t next = Next();
+    if (next != NOT_FOUND)
+    {
+        Remove(next);
+    }
+}
+
+bool RateShaper::PopUnsentOrder(unsigned long& clientOrderId) noexcept
+{
+    if (mUnsentCount == 0)
+    {
+        return false;
+    }
+    clientOrderId = mUnsentOrders[--mUnsentCount];
+    return true;
+}
+
+}
@@ -0,0 +1,102 @@
+// Copyright 2021 Optiver Asia Pacific Pty. Ltd.
+//
+// This file is part of Ready Trader Go.
+//
+//     Ready Trader Go is free software: you can redistribute it and/or
+//     modify it under the terms of the GNU Affero General Public License
+//     as published by the Free Software Foundation, either version 3 of
+//     the License, or (at your option) any later version.
+//
+//     Ready Trader Go is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU Affero General Public License for more details.
+//
+//     You should have received a copy of the GNU Affero General Public
+//     License along with Ready Trader Go.  If not, see
+//     <https://www.gnu.org/licenses/>.
+#ifndef CPPREADY_TRADER_GO_LIBS_READY_TRADER_GO_RATESHAPER_H
+#define CPPREADY_TRADER_GO_LIBS_READY_TRADER_GO_RATESHAPER_H
+
+#include <array>
+#include <cstddef>
+
+#include "types.h"
+
+namespace ReadyTraderGo {
+
+// Number of execution requests that may wait for message budget at once.
+constexpr std::size_t RATE_SHAPER_CAPACITY = 64;
+
+enum class RequestType : unsigned char { AMEND, CANCEL, HEDGE, INSERT };
+
+// An execution request waiting to be sent. Fields that do not apply to the
+// request's type are ignored.
+struct QueuedRequest
+{
+    unsigned long mClientOrderId = 0;
+    unsigned long mPrice = 0;
+    unsigned long mVolume = 0;
+    RequestType mType = RequestType::CANCEL;
+    Side mSide = Side::SELL;
+    Lifespan mLifespan = Lifespan::GOOD_FOR_DAY;
+};
+
+// Holds execution requests that cannot be sent yet because the message
+// frequency budget is spent, and releases the most important first.
+//
+// Cancels are released before amends, and both before inserts and hedges,
+// which keep their order relative to each other because the exchange
+// requires new client order ids to increase. Redundant requests are combined
+// while queued: a cancel or zero-volume amend of an order whose insert is
+// still queued removes the insert, a later amend replaces an earlier one,
+// an amend of a queued insert changes the insert's volume, and a cancel
+// replaces queued amends and duplicate cancels of the same order. Orders
+// whose insert was removed are kept so they can be reported as cancelled.
+//
+// The queue is a fixed array searched linearly, which is cheap at this size
+// and never allocates.
+class RateShaper
+{
+public:
+    explicit RateShaper(unsigned long messageFrequencyLimit) { SetMessageFrequencyLimit(messageFrequencyLimit); }
+
+    // Inserts must leave a tenth of the message frequency limit for cancels,
+    // amends and hedges, which reduce risk.
+    void SetMessageFrequencyLimit(unsigned long limit) noexcept { mInsertReserve = limit / 10; }
+
+    // Number of messages of budget an insert must leave before it may be sent.
+    std::size_t GetInsertReserve() const noexcept { return mInsertReserve; }
+
+    bool IsEmpty() const noexcept { return mCount == 0 && mUnsentCount == 0; }
+
+    // Queue a request, combining it with queued requests where possible.
+    // Returns false if the queue is full.
+    bool Push(const QueuedRequest& request) noexcept;
+
+    // Return the next request to release or nullptr if none is queued.
+    const QueuedRequest* Front() const noexcept;
+
+    // Remove the request returned by Front.
+    void Pop() noexcept;
+
+    // Take the id of an order whose insert was removed before it was sent.
+    // Returns false if there are none.
+    bool PopUnsentOrder(unsigned long& clientOrderId) noexcept;
+
+private:
+    std::size_t Find(RequestType type, unsigned long clientOrderId) const noexcept;
+    std::size_t Next() const noexcept;
+    void Remove(std::size_t index) noexcept;
+    bool Cancel(unsigned long clientOrderId) noexcept;
+
+    std::array<QueuedRequest, RATE_SHAPER_CAPACITY> mRequests;
+    std::size_t mCount = 0;
+    std::array<unsigned long, RATE_SHAPER_CAPACITY> mUnsentOrders;
+    std::size_t mUnsentCount = 0;
+    std::size_t mInsertReserve;
+};
+
+}
+
+#endif //CPPREADY_TRADER_GO_LIBS_READY_TRADER_GO_RATESHAPER_H
@@ -0,0 +1,120 @@
+// Copyright 2021 Optiver Asia Pacific Pty. Ltd.
+//
+// This file is part of Ready Trader Go.
+//
+//     Ready Trader Go is free software: you can redistribute it and/or
+//     modify it under the terms of the GNU Affero General Public License
+//     as published by the Free Software Foundation, either version 3 of
+//     the License, or (at your option) any later version.
+//
+//     Ready Trader Go is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU Affero General Public License for more details.
+//
+//     You should have received a copy of the GNU Affero General Public
+//     License along with Ready Trader Go.  If not, see
+//     <https://www.gnu.org/licenses/>.
+#include "riskgate.h"
+
+namespace ReadyTraderGo {
+
+RiskGate::RiskGate(const RiskLimits& limits)
+{
+    SetLimits(limits);
+}
+
+void RiskGate::SetLimits(const RiskLimits& limits)
+{
+    mLimits = limits;
+    mMessageTimes.assign(limits.mMessageFrequencyLimit, 0.0);
+    mNextMessage = 0;
+    mMessageCount = 0;
+}
+
+RiskCheck RiskGate::CheckHedge(unsigned long clientOrderId, Side side, unsigned long price, unsigned long volume)
+{
+    if (!IsWithinLimit(mFuturePosition, side, mHedges.GetVolume(side), volume, mLimits.mPositionLimit))
+    {
+        return RiskCheck::POSITION_LIMIT;
+    }
+
+    RiskCheck check = CheckMessage();
+    if (check == RiskCheck::ACCEPTED)
+    {
+        mHedges.Insert(clientOrderId, side, price, volume);
+    }
+    return check;
+}
+
+RiskCheck RiskGate::CheckInsert(unsigned long clientOrderId, Side side, unsigned long price, unsigned long volume)
+{
+    if (mOrders.GetCount() >= mLimits.mActiveOrderCountLimit)
+    {
+        return RiskCheck::ACTIVE_ORDER_COUNT_LIMIT;
+    }
+
+    if (mOrders.GetVolume(Side::BUY) + mOrders.GetVolume(Side::SELL) + volume > mLimits.mActiveVolumeLimit)
+    {
+        return RiskCheck::ACTIVE_VOLUME_LIMIT;
+    }
+
+    if (!IsWithinLimit(mEtfPosition, side, mOrders.GetVolume(side), volume, mLimits.mPositionLimit))
+    {
+        return RiskCheck::POSITION_LIMIT;
+    }
+
+    RiskCheck check = CheckMessage();
+    if (check == RiskCheck::ACCEPTED)
+    {
+        mOrders.Insert(clientOrderId, side, price, volume);
+    }
+    return check;
+}
+
+void RiskGate::OnError(unsigned long clientOrderId) noexcept
+{
+    // An error about an order that the exchange has not yet acknowledged
+    // means the order was rejected. Errors about live orders (such as a
+    // rejected amend) leave them in place.
+    TrackedOrder* order = mOrders.Find(clientOrderId);
+    if (order != nullptr && order->mState == OrderState::PENDING)
+    {
+        mOrders.Erase(clientOrderId);
+    }
+    mHedges.Erase(clientOrderId);
+}
+
+void RiskGate::OnHedgeFilled(unsigned long clientOrderId, unsigned long volume) noexcept
+{
+    TrackedOrder* hedge = mHedges.Find(clientOrderId);
+    if (hedge != nullptr)
+    {
+        mFuturePosition += (hedge->mSide == Side::BUY) ? static_cast<long>(volume) : -static_cast<long>(volume);
+        mHedges.Erase(clientOrderId);
+    }
+}
+
+void RiskGate::OnOrderFilled(unsigned long clientOrderId, unsigned long volume) noexcept
+{
+    TrackedOrder* order = mOrders.Find(clientOrderId);
+    if (order != nullptr)
+    {
+        mEtfPosition += (order->mSide == Side::BUY) ? static_cast<long>(volume) : -static_cast<long>(volume);
+        mOrders.Fill(*order, volume);
+    }
+}
+
+void RiskGate::OnOrderStatus(unsigned long clientOrderId, unsigned long remainingVolume) noexcept
+{
+    if (remainingVolume == 0)
+    {
+        mOrders.Erase(clientOrderId);
+    }
+    else if (TrackedOrder* order = mOrders.Find(clientOrderId))
+    {
+        mOrders.Update(*order, remainingVolume);
+    }
+}
+
+}
@@ -0,0 +1,229 @@
+// Copyright 2021 Optiver Asia Pacific Pty. Ltd.
+//
+// This file is part of Ready Trader Go.
+//
+//     Ready Trader Go is free software: you can redistribute it and/or
+//     modify it under the terms of the GNU Affero General Public License
+//     as published by the Free Software Foundation, either version 3 of
+//     the License, or (at your option) any later version.
+//
+//     Ready Trader Go is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU Affero General Public License for more details.
+//
+//     You should have received a copy of the GNU Affero General Public
+//     License along with Ready Trader Go.  If not, see
+//     <https://www.gnu.org/licenses/>.
+#ifndef CPPREADY_TRADER_GO_LIBS_READY_TRADER_GO_RISKGATE_H
+#define CPPREADY_TRADER_GO_LIBS_READY_TRADER_GO_RISKGATE_H
+
+#include <chrono>
+#include <cstddef>
+#include <functional>
+#include <limits>
+#include <ostream>
+#include <vector>
+
+#include <boost/property_tree/ptree.hpp>
+
+#include "ordertable.h"
+#include "types.h"
+
+namespace ReadyTraderGo {
+
+// The limits the exchange imposes on each auto-trader. The defaults match
+// the "Limits" section of the supplied exchange.json.
+struct RiskLimits
+{
+    void readFromPropertyTree(const boost::property_tree::ptree& tree)
+    {
+        mActiveOrderCountLimit = tree.get<unsigned long>("ActiveOrderCountLimit", mActiveOrderCountLimit);
+        mActiveVolumeLimit = tree.get<unsigned long>("ActiveVolumeLimit", mActiveVolumeLimit);
+        mMessageFrequencyInterval = tree.get<double>("MessageFrequencyInterval", mMessageFrequencyInterval);
+        mMessageFrequencyLimit = tree.get<unsigned long>("MessageFrequencyLimit", mMessageFrequencyLimit);
+        mPositionLimit = tree.get<long>("PositionLimit", mPositionLimit);
+    }
+
+    unsigned long mActiveOrderCountLimit = 10;
+    unsigned long mActiveVolumeLimit = 200;
+    double mMessageFrequencyInterval = 1.0;
+    unsigned long mMessageFrequencyLimit = 50;
+    long mPositionLimit = 100;
+};
+
+enum class RiskCheck : unsigned char
+{
+    ACCEPTED,
+    ACTIVE_ORDER_COUNT_LIMIT,
+    ACTIVE_VOLUME_LIMIT,
+    MESSAGE_FREQUENCY_LIMIT,
+    POSITION_LIMIT,
+    REQUEST_QUEUE_LIMIT
+};
+
+template<typename C, typename T>
+std::basic_ostream<C, T>& operator<<(std::basic_ostream<C, T>& strm, RiskCheck check)
+{
+    switch (check)
+    {
+    case RiskCheck::ACCEPTED:
+        strm << "accepted";
+        break;
+    case RiskCheck::ACTIVE_ORDER_COUNT_LIMIT:
+        strm << "active order count limit";
+        break;
+    case RiskCheck::ACTIVE_VOLUME_LIMIT:
+        strm << "active volume limit";
+        break;
+    case RiskCheck::MESSAGE_FREQUENCY_LIMIT:
+        strm << "message frequency limit";
+        break;
+    case RiskCheck::POSITION_LIMIT:
+        strm << "position limit";
+        break;
+    case RiskCheck::REQUEST_QUEUE_LIMIT:
+        strm << "request queue limit";
+        break;
+    }
+    return strm;
+}
+
+// Checks each execution request against the exchange's limits before it is
+// sent, so that a request that would be rejected, or that would breach a
+// limit and end the match, never leaves the auto-trader.
+//
+// The gate tracks the active orders and their volume, the ETF and future
+// positions assuming every active order and outstanding hedge is filled, and
+// the times of the most recent messages in a ring with one slot per message
+// allowed in the frequency interval. Every check takes constant time and
+// nothing is allocated after the limits are set.
+//
+// Requests that pass their checks are recorded as sent; the exchange's
+// replies must be passed to the On* methods to keep the state up to date.
+class RiskGate
+{
+public:
+    explicit RiskGate(const RiskLimits& limits = RiskLimits{});
+
+    const RiskLimits& GetLimits() const noexcept { return mLimits; }
+    void SetLimits(const RiskLimits& limits);
+
+    // Replace the source of the current time in seconds, which by default is
+    // the steady clock. A simulation may supply its own simulated time.
+    void SetClock(std::function<double()> clock) { mClock = std::move(clock); }
+
+    // True if at least reserve + 1 messages could be sent now without
+    // exceeding the message frequency limit.
+    bool HasMessageBudget(std::size_t reserve = 0) const;
+
+    RiskCheck CheckAmend() { return CheckMessage(); }
+    RiskCheck CheckCancel() { return CheckMessage(); }
+    RiskCheck CheckHedge(unsigned long clientOrderId, Side side, unsigned long price, unsigned long volume);
+    RiskCheck CheckInsert(unsigned long clientOrderId, Side side, unsigned long price, unsigned long volume);
+
+    // The current time in seconds from the gate's clock.
+    double Now() const
+    {
+        if (mClock)
+        {
+            return mClock();
+        }
+        using seconds = std::chrono::duration<double>;
+        return std::chrono::duration_cast<seconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    void OnError(unsigned long clientOrderId) noexcept;
+    void OnHedgeFilled(unsigned long clientOrderId, unsigned long volume) noexcept;
+    void OnOrderFilled(unsigned long clientOrderId, unsigned long volume) noexcept;
+    void OnOrderStatus(unsigned long clientOrderId, unsigned long remainingVolume) noexcept;
+
+    long GetEtfPosition() const noexcept { return mEtfPosition; }
+    long GetFuturePosition() const noexcept { return mFuturePosition; }
+    const OrderTable& GetOrders() const noexcept { return mOrders; }
+
+private:
+    // Check that one more message would not exceed the message frequency
+    // limit and, if not, record it.
+    RiskCheck CheckMessage();
+
+    // True if a message sent at the given time has left the frequency
+    // interval (using the same test as the exchange's frequency limiter).
+    bool HasExpired(double sent, double now) const noexcept
+    {
+        double windowStart = now - mLimits.mMessageFrequencyInterval;
+        return (sent - windowStart) <= ((sent > windowStart) ? sent : windowStart) * std::numeric_limits<double>::epsilon();
+    }
+
+    static bool IsWithinLimit(long position, Side side, unsigned long pending, unsigned long volume, long limit) noexcept
+    {
+        long worst = (side == Side::BUY) ? position + static_cast<long>(pending + volume)
+                                         : position - static_cast<long>(pending + volume);
+        return -limit <= worst && worst <= limit;
+    }
+
+    RiskLimits mLimits;
+    std::function<double()> mClock;
+
+    OrderTable mOrders;
+    OrderTable mHedges;
+    long mEtfPosition = 0;
+    long mFuturePosition = 0;
+
+    std::vector<double> mMessageTimes;
+    std::size_t mNextMessage = 0;
+    std::size_t mMessageCount = 0;
+};
+
+inline RiskCheck RiskGate::CheckMessage()
+{
+    if (mMessageTimes.empty())
+    {
+        return RiskCheck::MESSAGE_FREQUENCY_LIMIT;
+    }
+
+    // The slot to be reused holds the time of the message sent the limit
+    // number of messages ago, which must have left the interval.
+    double now = Now();
+    if (mMessageCount == mMessageTimes.size())
+    {
+        if (!HasExpired(mMessageTimes[mNextMessage], now))
+        {
+            return RiskCheck::MESSAGE_FREQUENCY_LIMIT;
+        }
+    }
+    else
+    {
+        ++mMessageCount;
+    }
+
+    mMessageTimes[mNextMessage] = now;
+    if (++mNextMessage == mMessageTimes.size())
+    {
+        mNextMessage = 0;
+    }
+    return RiskCheck::ACCEPTED;
+}
+
+inline bool RiskGate::HasMessageBudget(std::size_t reserve) const
+{
+    std::size_t size = mMessageTimes.size();
+    if (mMessageCount + reserve < size)
+    {
+        return true;
+    }
+    if (reserve >= size)
+    {
+        return false;
+    }
+
+    // The times in the ring are in order, so the budget exceeds the reserve
+    // if the message that would be the reserve + 1th to expire has expired.
+    std::size_t oldest = (mMessageCount == size) ? mNextMessage : 0;
+    std::size_t index = (oldest + reserve - (size - mMessageCount)) % size;
+    return HasExpired(mMessageTimes[index], Now());
+}
+
+}
+
+#endif //CPPREADY_TRADER_GO_LIBS_READY_TRADER_GO_RISKGATE_H
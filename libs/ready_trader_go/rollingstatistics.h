@@ -0,0 +1,161 @@
+// Copyright 2021 Optiver Asia Pacific Pty. Ltd.
+//
+// This file is part of Ready Trader Go.
+//
+//     Ready Trader Go is free software: you can redistribute it and/or
+//     modify it under the terms of the GNU Affero General Public License
+//     as published by the Free Software Foundation, either version 3 of
+//     the License, or (at your option) any later version.
+//
+//     Ready Trader Go is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU Affero General Public License for more details.
+//
+//     You should have received a copy of the GNU Affero General Public
+//     License along with Ready Trader Go.  If not, see
+//     <https://www.gnu.org/licenses/>.
+#ifndef CPPREADY_TRADER_GO_LIBS_READY_TRADER_GO_ROLLINGSTATISTICS_H
+#define CPPREADY_TRADER_GO_LIBS_READY_TRADER_GO_ROLLINGSTATISTICS_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "error.h"
+#include "fixedpoint.h"
+
+namespace ReadyTraderGo {
+
+// The mean and population standard deviation of the most recent values in
+// a series of fixed-point numbers over one or more window sizes. Values are
+// kept in a ring sized for the largest window and each window keeps running
+// sums, so Push costs O(1) per window regardless of the window sizes.
+//
+// The sums are kept exactly, as 128-bit integers of each value's offset from
+// the first, so they never need recomputing and the same values always give
+// the same results. The mean and standard deviation are rounded to the
+// nearest value T can represent.
+template<typename T>
+class FixedRollingStatistics
+{
+public:
+    explicit FixedRollingStatistics(std::vector<std::size_t> windowSizes);
+
+    void Push(T value) noexcept;
+
+    // Number of values pushed so far.
+    std::size_t GetCount() const noexcept { return mCount; }
+
+    std::size_t GetWindowSize(std::size_t window = 0) const noexcept { return mWindows[window].mSize; }
+
+    // True once the window holds as many values as its size.
+    bool IsFull(std::size_t window = 0) const noexcept { return mCount >= mWindows[window].mSize; }
+
+    // Statistics of the values in the window, which holds fewer values than
+    // its size until it is full.
+    T GetMean(std::size_t window = 0) const noexcept;
+    T GetStandardDeviation(std::size_t window = 0) const noexcept;
+
+private:
+    struct Window
+    {
+        std::size_t mSize;
+        FixedPointWide mSum = 0;
+        FixedPointWide mSumOfSquares = 0;
+    };
+
+    std::size_t CountIn(const Window& window) const noexcept
+    {
+        return (mCount < window.mSize) ? mCount : window.mSize;
+    }
+
+    std::vector<Window> mWindows;
+    std::vector<std::int64_t> mValues;
+    std::size_t mMask;
+    std::size_t mCount = 0;
+    std::int64_t mReference = 0;
+};
+
+template<typename T>
+FixedRollingStatistics<T>::FixedRollingStatistics(std::vector<std::size_t> windowSizes)
+{
+    std::size_t largest = 0;
+    for (std::size_t size : windowSizes)
+    {
+        if (size == 0)
+        {
+            throw ReadyTraderGoError("rolling statistics window sizes must be positive");
+        }
+        largest = (size > largest) ? size : largest;
+        mWindows.push_back(Window{size});
+    }
+    if (mWindows.empty())
+    {
+        throw ReadyTraderGoError("rolling statistics window sizes must be positive");
+    }
+
+    std::size_t capacity = 1;
+    while (capacity < largest)
+    {
+        capacity <<= 1;
+    }
+    mValues.assign(capacity, 0);
+    mMask = capacity - 1;
+}
+
+template<typename T>
+inline void FixedRollingStatistics<T>::Push(T value) noexcept
+{
+    if (mCount == 0)
+    {
+        mReference = value.GetRaw();
+    }
+
+    FixedPointWide offset = value.GetRaw() - mReference;
+    for (Window& window : mWindows)
+    {
+        if (mCount >= window.mSize)
+        {
+            FixedPointWide leaving = mValues[(mCount - window.mSize) & mMask] - mReference;
+            window.mSum -= leaving;
+            window.mSumOfSquares -= leaving * leaving;
+        }
+        window.mSum += offset;
+        window.mSumOfSquares += offset * offset;
+    }
+
+    mValues[mCount & mMask] = value.GetRaw();
+    ++mCount;
+}
+
+template<typename T>
+inline T FixedRollingStatistics<T>::GetMean(std::size_t window) const noexcept
+{
+    const Window& w = mWindows[window];
+    std::size_t n = CountIn(w);
+    if (n == 0)
+    {
+        return T{};
+    }
+    return T::FromRaw(mReference + static_cast<std::int64_t>(roundedDivide(w.mSum, n)));
+}
+
+template<typename T>
+inline T FixedRollingStatistics<T>::GetStandardDeviation(std::size_t window) const noexcept
+{
+    const Window& w = mWindows[window];
+    std::size_t n = CountIn(w);
+    if (n == 0)
+    {
+        return T{};
+    }
+    // n^2 times the variance, which is exact and never negative.
+    FixedPointWide scaled = w.mSumOfSquares * static_cast<FixedPointWide>(n) - w.mSum * w.mSum;
+    auto root = static_cast<FixedPointWide>(integerSquareRoot(static_cast<FixedPointUnsignedWide>(scaled)));
+    return T::FromRaw(static_cast<std::int64_t>(roundedDivide(root, n)));
+}
+
+}
+
+#endif //CPPREADY_TRADER_GO_LIBS_READY_TRADER_GO_ROLLINGSTATISTICS_H
@@ -0,0 +1,657 @@
+// Copyright 2021 Optiver Asia Pacific Pty. Ltd.
+//
+// This file is part of Ready Trader Go.
+//
+//     Ready Trader Go is free software: you can redistribute it and/or
+//     modify it under the terms of the GNU Affero General Public License
+//     as published by the Free Software Foundation, either version 3 of
+//     the License, or (at your option) any later version.
+//
+//     Ready Trader Go is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU Affero General Public License for more details.
+//
+//     You should have received a copy of the GNU Affero General Public
+//     License along with Ready Trader Go.  If not, see
+//     <https://www.gnu.org/licenses/>.
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+
+#include "error.h"
+#include "logging.h"
+#include "protocol.h"
+#include "riskgate.h"
+#include "simulator.h"
+
+RTG_INLINE_GLOBAL_LOGGER_WITH_CHANNEL(LG_SIM, "SIM")
+
+namespace ReadyTraderGo {
+
+namespace {
+
+// Append the serialised message to the queue, leaving the queue as it was
+// if the message is too large.
+void serialise(std::deque<SimulatedMessage>& queue, bool isInformation, unsigned char messageType,
+               const ISerialisable& serialisable)
+{
+    const std::size_t size = serialisable.Size();
+    if (size > SIMULATED_MESSAGE_CAPACITY)
+    {
+        throw ReadyTraderGoError("simulated message too large");
+    }
+    SimulatedMessage& message = queue.emplace_back();
+    message.mIsInformation = isInformation;
+    message.mType = messageType;
+    message.mSize = size;
+    serialisable.Serialise(message.mData.data());
+}
+
+std::size_t instrumentIndex(Instrument instrument)
+{
+    return static_cast<std::size_t>(instrument);
+}
+
+}
+
+void CompetitorAccount::Transact(Instrument instrument, Side side, unsigned long price, unsigned long volume, long fee)
+{
+    long value = static_cast<long>(price * volume);
+    mAccountBalance += (side == Side::SELL) ? value : -value;
+    mAccountBalance -= fee;
+    mTotalFees += fee;
+
+    long delta = (side == Side::SELL) ? -static_cast<long>(volume) : static_cast<long>(volume);
+    if (instrument == Instrument::FUTURE)
+    {
+        mFuturePosition += delta;
+    }
+    else
+    {
+        mEtfPosition += delta;
+        ((side == Side::SELL) ? mSellVolume : mBuyVolume) += volume;
+    }
+}
+
+void CompetitorAccount::Update(long futurePrice, long etfPrice)
+{
+    long delta = static_cast<long>(std::nearbyint(mEtfClamp * static_cast<double>(futurePrice)));
+    delta -= delta % mTickSize;
+    long minPrice = futurePrice - delta;
+    long maxPrice = futurePrice + delta;
+    long clamped = (etfPrice < minPrice) ? minPrice : (etfPrice > maxPrice) ? maxPrice : etfPrice;
+
+    mProfitOrLoss = mAccountBalance + mFuturePosition * futurePrice + mEtfPosition * clamped;
+    if (mProfitOrLoss > mMaxProfit)
+    {
+        mMaxProfit = mProfitOrLoss;
+    }
+    if (mMaxProfit - mProfitOrLoss > mMaxDrawdown)
+    {
+        mMaxDrawdown = mMaxProfit - mProfitOrLoss;
+    }
+}
+
+bool FrequencyLimiter::CheckEvent(double now)
+{
+    mEvents.push_back(now);
+    constexpr double epsilon = std::numeric_limits<double>::epsilon();
+    double windowStart = now - mInterval;
+    while ((mEvents.front() - windowStart) <= (std::max(mEvents.front(), windowStart) * epsilon))
+    {
+        mEvents.pop_front();
+    }
+    return mEvents.size() > mLimit;
+}
+
+void SimulatedConnection::SendEncoded(unsigned char const* data, std::size_t size, SendMode)
+{
+    if (size < MESSAGE_HEADER_SIZE || size - MESSAGE_HEADER_SIZE > SIMULATED_MESSAGE_CAPACITY)
+    {
+        throw ReadyTraderGoError("simulated message too large");
+    }
+    SimulatedMessage& message = mOutbound.emplace_back();
+    message.mType = data[MESSAGE_TYPE_OFFSET];
+    message.mSize = size - MESSAGE_HEADER_SIZE;
+    std::memcpy(message.mData.data(), data + MESSAGE_HEADER_SIZE, message.mSize);
+}
+
+void SimulatedConnection::SendMessage(unsigned char messageType, const ISerialisable& serialisable, SendMode)
+{
+    serialise(mOutbound, false, messageType, serialisable);
+}
+
+void Simulator::MarketOrders::OnOrderAmended(double now, Order& order, unsigned long)
+{
+    if (order.mRemainingVolume == 0)
+    {
+        OnOrderCancelled(now, order, 0);
+    }
+}
+
+void Simulator::MarketOrders::OnOrderCancelled(double, Order& order, unsigned long)
+{
+    // The map may hold the last reference to the order
+    unsigned long orderId = order.mClientOrderId;
+    mOrders[instrumentIndex(order.mInstrument)].erase(orderId);
+}
+
+void Simulator::MarketOrders::OnOrderFilled(double now, Order& order, unsigned long, unsigned long, long)
+{
+    if (order.mRemainingVolume == 0)
+    {
+        OnOrderCancelled(now, order, 0);
+    }
+}
+
+Simulator::Simulator(const SimulatorConfig& config, IMarketEventSource& events)
+    : mConfig(config),
+      mEvents(events),
+      mFutureBook(Instrument::FUTURE, 0.0, 0.0),
+      mEtfBook(Instrument::ETF, config.mMakerFee, config.mTakerFee),
+      mResult(config),
+      mLimiter(config.mMessageFrequencyInterval, config.mMessageFrequencyLimit),
+      mTickSize(static_cast<long>(config.mTickSize * 100.0))
+{
+    mFutureBook.TradeOccurred = [this](OrderBook&) { mHasTrades[instrumentIndex(Instrument::FUTURE)] = true; };
+    mEtfBook.TradeOccurred = [this](OrderBook&) { mHasTrades[instrumentIndex(Instrument::ETF)] = true; };
+    mHasNextEvent = mEvents.Next(mNextEvent);
+}
+
+void Simulator::Attach(BaseAutoTrader& autoTrader)
+{
+    // The auto-trader's risk gate checks requests against this exchange's
+    // limits in simulated time.
+    RiskLimits limits;
+    limits.mActiveOrderCountLimit = mConfig.mActiveOrderCountLimit;
+    limits.mActiveVolumeLimit = mConfig.mActiveVolumeLimit;
+    limits.mMessageFrequencyInterval = mConfig.mMessageFrequencyInterval;
+    limits.mMessageFrequencyLimit = mConfig.mMessageFrequencyLimit;
+    limits.mPositionLimit = mConfig.mPositionLimit;
+    autoTrader.SetRiskLimits(limits);
+    autoTrader.GetRiskGate().SetClock([this] { return mNow; });
+
+    auto subscription = std::make_shared<SimulatedSubscription>();
+    mSubscription = subscription.get();
+    autoTrader.SetInformationSubscription(std::move(subscription));
+
+    auto connection = std::make_unique<SimulatedConnection>(mFromAutoTrader);
+    mConnection = connection.get();
+    autoTrader.SetExecutionConnection(std::move(connection));
+}
+
+SimulationResult Simulator::Run()
+{
+    if (!mConnection)
+    {
+        throw ReadyTraderGoError("no auto-trader attached to the simulator");
+    }
+
+    // Market events are processed in batches every market event interval and
+    // order books are published every tick interval. When both fall due at
+    // the same time the market events are processed first.
+    unsigned long marketTickNumber = 0;
+    unsigned long tickNumber = 1;
+    double nextMarketTime = 0.0;
+    double nextTickTime = 0.0;
+
+    mIsRunning = true;
+    while (mIsRunning)
+    {
+        if (nextMarketTime <= nextTickTime)
+        {
+            mNow = nextMarketTime;
+            ProcessMarketEvents();
+            nextMarketTime = static_cast<double>(++marketTickNumber) * mConfig.mMarketEventInterval;
+        }
+        else
+        {
+            mNow = nextTickTime;
+            long futurePrice = static_cast<long>(mFutureBook.GetLastTradedPrice());
+            long etfPrice = static_cast<long>(mEtfBook.GetLastTradedPrice());
+            mResult.mAccount.Update(futurePrice, etfPrice);
+            if (!mHasNextEvent)
+            {
+                RLOG(LG_SIM, LogLevel::LL_INFO) << "match complete at " << mNow;
+                break;
+            }
+            PublishOrderBooks(tickNumber);
+            nextTickTime = static_cast<double>(tickNumber++) * mConfig.mTickInterval;
+        }
+
+        PublishTradeTicks();
+        Settle();
+
+        if (mIsRunning && mUnhedgedLots.HasExpired(mNow))
+        {
+            HardBreach(0, "held unhedged lots for longer than the time limit");
+        }
+    }
+
+    mIsRunning = false;
+    mResult.mEndTime = mNow;
+    mConnection->Close();
+    return mResult;
+}
+
+void Simulator::HardBreach(unsigned long clientOrderId, const std::string& message)
+{
+    RLOG(LG_SIM, LogLevel::LL_INFO) << "hard breach at " << mNow << ": " << message;
+    mResult.mStatus = "BREACH";
+    mResult.mReason = message;
+    SendError(clientOrderId, message);
+    mIsRunning = false;
+
+    // Let the auto-trader see the error before it is disconnected.
+    while (!mToAutoTrader.empty())
+    {
+        SimulatedMessage message = mToAutoTrader.front();
+        mToAutoTrader.pop_front();
+        mConnection->Deliver(message);
+    }
+}
+
+void Simulator::OnAmendMessage(unsigned long clientOrderId, unsigned long volume)
+{
+    if (static_cast<long>(clientOrderId) > mLastClientOrderId)
+    {
+        SendError(clientOrderId, "out-of-order client_order_id in amend message");
+        return;
+    }
+
+    auto it = mOrders.find(clientOrderId);
+    if (it != mOrders.end())
+    {
+        if (volume > it->second->mVolume)
+        {
+            SendError(clientOrderId, "amend operation would increase order volume");
+        }
+        else
+        {
+            mEtfBook.Amend(mNow, *it->second, volume);
+        }
+    }
+}
+
+void Simulator::OnCancelMessage(unsigned long clientOrderId)
+{
+    if (static_cast<long>(clientOrderId) > mLastClientOrderId)
+    {
+        SendError(clientOrderId, "out-of-order client_order_id in cancel message");
+        return;
+    }
+
+    auto it = mOrders.find(clientOrderId);
+    if (it != mOrders.end())
+    {
+        mEtfBook.Cancel(mNow, *it->second);
+    }
+}
+
+void Simulator::OnHedgeMessage(unsigned long clientOrderId, Side side, unsigned long price, unsigned long volume)
+{
+    if (static_cast<long>(clientOrderId) <= mLastClientOrderId)
+    {
+        SendError(clientOrderId, "duplicate or out-of-order client_order_id");
+        return;
+    }
+    mLastClientOrderId = static_cast<long>(clientOrderId);
+
+    if (side != Side::BUY && side != Side::SELL)
+    {
+        SendError(clientOrderId, std::to_string(static_cast<int>(side)) + " is not a valid side");
+        return;
+    }
+    if (price % mTickSize != 0)
+    {
+        SendError(clientOrderId, "price is not a multiple of tick size");
+        return;
+    }
+    if (volume < 1)
+    {
+        SendError(clientOrderId, "order rejected: invalid volume");
+        return;
+    }
+    if (mNow == 0.0)
+    {
+        SendError(clientOrderId, "order rejected: market not yet open");
+        return;
+    }
+
+    auto [volumeTraded, averagePrice] = mFutureBook.TryTrade(side, price, volume);
+    if (volumeTraded > 0)
+    {
+        long delta = static_cast<long>(volumeTraded);
+        mUnhedgedLots.ApplyPositionDelta(mNow, (side == Side::BUY) ? delta : -delta);
+        mResult.mAccount.Transact(Instrument::FUTURE, side, averagePrice, volumeTraded, 0);
+        auto priceOf = [](const OrderBook& book)
+        {
+            unsigned long last = book.GetLastTradedPrice();
+            return last ? static_cast<long>(last) : static_cast<long>(std::nearbyint(book.GetMidpointPrice()));
+        };
+        mResult.mAccount.Update(priceOf(mFutureBook), priceOf(mEtfBook));
+        ++mResult.mHedgeCount;
+    }
+
+    Send(false, MessageType::HEDGE_FILLED, HedgeFilledMessage{clientOrderId, averagePrice, volumeTraded});
+    if (std::labs(mResult.mAccount.mFuturePosition) > mConfig.mPositionLimit)
+    {
+        HardBreach(clientOrderId, "future position limit breached");
+    }
+}
+
+void Simulator::OnInsertMessage(unsigned long clientOrderId,
+                                Side side,
+                                unsigned long price,
+                                unsigned long volume,
+                                Lifespan lifespan)
+{
+    if (static_cast<long>(clientOrderId) <= mLastClientOrderId)
+    {
+        SendError(clientOrderId, "duplicate or out-of-order client_order_id");
+        return;
+    }
+    mLastClientOrderId = static_cast<long>(clientOrderId);
+
+    if (side != Side::BUY && side != Side::SELL)
+    {
+        SendError(clientOrderId, std::to_string(static_cast<int>(side)) + " is not a valid side");
+        return;
+    }
+    if (lifespan != Lifespan::FILL_AND_KILL && lifespan != Lifespan::GOOD_FOR_DAY)
+    {
+        SendError(clientOrderId, std::to_string(static_cast<int>(lifespan)) + " is not a valid lifespan");
+        return;
+    }
+    if (price % mTickSize != 0)
+    {
+        SendError(clientOrderId, "price is not a multiple of tick size");
+        return;
+    }
+    if (mOrders.size() == mConfig.mActiveOrderCountLimit)
+    {
+        SendError(clientOrderId, "order rejected: active order count limit breached");
+        return;
+    }
+    if (volume < 1)
+    {
+        SendError(clientOrderId, "order rejected: invalid volume");
+        return;
+    }
+    if (mActiveVolume + volume > mConfig.mActiveVolumeLimit)
+    {
+        SendError(clientOrderId, "order rejected: active order volume limit breached");
+        return;
+    }
+    if (mNow == 0.0)
+    {
+        SendError(clientOrderId, "order rejected: market not yet open");
+        return;
+    }
+    if ((side == Side::BUY && !mSellPrices.empty() && price >= *mSellPrices.begin())
+        || (side == Side::SELL && !mBuyPrices.empty() && price <= *mBuyPrices.rbegin()))
+    {
+        SendError(clientOrderId, "order rejected: in cross with an existing order");
+        return;
+    }
+
+    auto order = std::make_shared<Order>(clientOrderId, Instrument::ETF, lifespan, side, price, volume,
+                                         static_cast<IOrderListener*>(this));
+    mOrders.emplace(clientOrderId, order);
+    ((side == Side::BUY) ? mBuyPrices : mSellPrices).insert(price);
+    mActiveVolume += volume;
+    mEtfBook.Insert(mNow, order);
+}
+
+void Simulator::OnMessage(const SimulatedMessage& message)
+{
+    ++mResult.mMessageCount;
+    if (mLimiter.CheckEvent(mNow))
+    {
+        HardBreach(0, "message frequency limit breached");
+        return;
+    }
+
+    if (!mIsLoggedIn)
+    {
+        if (message.mType != MessageType::LOGIN)
+        {
+            HardBreach(0, "first message must be a login message");
+            return;
+        }
+        auto login = makeMessage<LoginMessage>(message.mData.data(), message.mSize);
+        RLOG(LG_SIM, LogLevel::LL_INFO) << "auto-trader logged in as '" << login.mName << '\'';
+        mIsLoggedIn = true;
+        return;
+    }
+
+    switch (message.mType)
+    {
+    case MessageType::AMEND_ORDER:
+    {
+        auto amend = makeMessage<AmendMessage>(message.mData.data(), message.mSize);
+        OnAmendMessage(amend.mClientOrderId, amend.mNewVolume);
+        break;
+    }
+    case MessageType::CANCEL_ORDER:
+    {
+        auto cancel = makeMessage<CancelMessage>(message.mData.data(), message.mSize);
+        OnCancelMessage(cancel.mClientOrderId);
+        break;
+    }
+    case MessageType::HEDGE_ORDER:
+    {
+        auto hedge = makeMessage<HedgeMessage>(message.mData.data(), message.mSize);
+        OnHedgeMessage(hedge.mClientOrderId, hedge.mSide, hedge.mPrice, hedge.mVolume);
+        break;
+    }
+    case MessageType::INSERT_ORDER:
+    {
+        auto insert = makeMessage<InsertMessage>(message.mData.data(), message.mSize);
+        OnInsertMessage(insert.mClientOrderId, insert.mSide, insert.mPrice, insert.mVolume, insert.mLifespan);
+        break;
+    }
+    default:
+        HardBreach(0, "received message with unexpected type " + std::to_string(message.mType));
+    }
+}
+
+void Simulator::OnOrderAmended(double, Order& order, unsigned long volumeRemoved)
+{
+    Send(false, MessageType::ORDER_STATUS, OrderStatusMessage{order.mClientOrderId,
+                                                              order.mVolume - order.mRemainingVolume,
+                                                              order.mRemainingVolume,
+                                                              order.mTotalFees});
+    mActiveVolume -= volumeRemoved;
+    if (order.mRemainingVolume == 0)
+    {
+        RemoveOrder(order);
+    }
+}
+
+void Simulator::OnOrderCancelled(double, Order& order, unsigned long volumeRemoved)
+{
+    Send(false, MessageType::ORDER_STATUS, OrderStatusMessage{order.mClientOrderId,
+                                                              order.mVolume - volumeRemoved,
+                                                              order.mRemainingVolume,
+                                                              order.mTotalFees});
+    mActiveVolume -= volumeRemoved;
+    RemoveOrder(order);
+}
+
+void Simulator::OnOrderPlaced(double, Order& order)
+{
+    // Only send an order status if the order has not partially filled
+    if (order.mVolume == order.mRemainingVolume)
+    {
+        Send(false, MessageType::ORDER_STATUS, OrderStatusMessage{order.mClientOrderId, 0,
+                                                                  order.mRemainingVolume,
+                                                                  order.mTotalFees});
+    }
+}
+
+void Simulator::OnOrderFilled(double now, Order& order, unsigned long price, unsigned long volume, long fee)
+{
+    mActiveVolume -= volume;
+    ++mResult.mFillCount;
+
+    long delta = static_cast<long>(volume);
+    mUnhedgedLots.ApplyPositionDelta(now, (order.mSide == Side::BUY) ? delta : -delta);
+
+    unsigned long lastTraded = mFutureBook.GetLastTradedPrice();
+    if (lastTraded == 0)
+    {
+        lastTraded = static_cast<unsigned long>(std::nearbyint(mFutureBook.GetMidpointPrice()));
+    }
+    mResult.mAccount.Transact(Instrument::ETF, order.mSide, price, volume, fee);
+    mResult.mAccount.Update(static_cast<long>(lastTraded), static_cast<long>(price));
+
+    Send(false, MessageType::ORDER_FILLED, OrderFilledMessage{order.mClientOrderId, price, volume});
+    Send(false, MessageType::ORDER_STATUS, OrderStatusMessage{order.mClientOrderId,
+                                                              order.mVolume - order.mRemainingVolume,
+                                                              order.mRemainingVolume,
+                                                              order.mTotalFees});
+
+    unsigned long clientOrderId = order.mClientOrderId;
+    if (order.mRemainingVolume == 0)
+    {
+        RemoveOrder(order);
+    }
+
+    if (mIsRunning && std::labs(mResult.mAccount.mEtfPosition) > mConfig.mPositionLimit)
+    {
+        HardBreach(clientOrderId, "ETF position limit breached");
+    }
+}
+
+void Simulator::ProcessMarketEvents()
+{
+    while (mHasNextEvent && mNextEvent.mTime < mNow)
+    {
+        const MarketEvent& event = mNextEvent;
+        OrderBook& book = (event.mInstrument == Instrument::FUTURE) ? mFutureBook : mEtfBook;
+        auto& orders = mMarketOrders.mOrders[instrumentIndex(event.mInstrument)];
+
+        if (event.mOperation == MarketEventOperation::INSERT)
+        {
+            auto order = std::make_shared<Order>(event.mOrderId, event.mInstrument, event.mLifespan, event.mSide,
+                                                 event.mPrice, static_cast<unsigned long>(event.mVolume),
+                                                 &mMarketOrders);
+            book.Insert(event.mTime, order);
+            if (order->mRemainingVolume > 0)
+            {
+                orders.emplace(event.mOrderId, std::move(order));
+            }
+        }
+        else
+        {
+            auto it = orders.find(event.mOrderId);
+            if (it != orders.end())
+            {
+                Order& order = *it->second;
+                if (event.mOperation == MarketEventOperation::CANCEL)
+                {
+                    book.Cancel(event.mTime, order);
+                }
+                else if (event.mVolume < 0)
+                {
+                    long newVolume = static_cast<long>(order.mVolume) + event.mVolume;
+                    book.Amend(event.mTime, order, static_cast<unsigned long>(std::max(newVolume, 0L)));
+                }
+            }
+        }
+
+        ++mResult.mMarketEventCount;
+        mHasNextEvent = mEvents.Next(mNextEvent);
+    }
+}
+
+void Simulator::PublishOrderBooks(unsigned long tickNumber)
+{
+    for (OrderBook* book : {&mFutureBook, &mEtfBook})
+    {
+        OrderBookMessage message;
+        message.mInstrument = book->GetInstrument();
+        message.mSequenceNumber = tickNumber;
+        book->TopLevels(message.mAskPrices, message.mAskVolumes, message.mBidPrices, message.mBidVolumes);
+        Send(true, MessageType::ORDER_BOOK_UPDATE, message);
+    }
+}
+
+void Simulator::PublishTradeTicks()
+{
+    for (OrderBook* book : {&mFutureBook, &mEtfBook})
+    {
+        std::size_t index = instrumentIndex(book->GetInstrument());
+        if (!mHasTrades[index])
+        {
+            continue;
+        }
+        mHasTrades[index] = false;
+
+        TradeTicksMessage message;
+        message.mInstrument = book->GetInstrument();
+        if (book->TradeTicks(message.mAskPrices, message.mAskVolumes, message.mBidPrices, message.mBidVolumes))
+        {
+            message.mSequenceNumber = ++mTradeTicksSequence[index];
+            Send(true, MessageType::TRADE_TICKS, message);
+        }
+    }
+}
+
+void Simulator::RemoveOrder(Order& order)
+{
+    auto& prices = (order.mSide == Side::BUY) ? mBuyPrices : mSellPrices;
+    auto price = prices.find(order.mPrice);
+    if (price != prices.end())
+    {
+        prices.erase(price);
+    }
+    // The map may hold the last reference to the order
+    unsigned long clientOrderId = order.mClientOrderId;
+    mOrders.erase(clientOrderId);
+}
+
+void Simulator::Send(bool isInformation, unsigned char messageType, const ISerialisable& serialisable)
+{
+    serialise(mToAutoTrader, isInformation, messageType, serialisable);
+}
+
+void Simulator::SendError(unsigned long clientOrderId, const std::string& message)
+{
+    ++mResult.mErrorCount;
+    Send(false, MessageType::ERROR_MESSAGE, ErrorMessage{clientOrderId, message});
+}
+
+void Simulator::Settle()
+{
+    // Deliver everything the exchange has sent, then handle everything the
+    // auto-trader sent in response, until both directions are quiet.
+    while (mIsRunning && (!mToAutoTrader.empty() || !mFromAutoTrader.empty()))
+    {
+        while (mIsRunning && !mToAutoTrader.empty())
+        {
+            SimulatedMessage message = mToAutoTrader.front();
+            mToAutoTrader.pop_front();
+            if (message.mIsInformation)
+            {
+                mSubscription->Deliver(message);
+            }
+            else
+            {
+                mConnection->Deliver(message);
+            }
+        }
+
+        while (mIsRunning && !mFromAutoTrader.empty())
+        {
+            SimulatedMessage message = mFromAutoTrader.front();
+            mFromAutoTrader.pop_front();
+            OnMessage(message);
+            PublishTradeTicks();
+        }
+    }
+}
+
+}
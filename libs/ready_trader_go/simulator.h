@@ -0,0 +1,259 @@
+// Copyright 2021 Optiver Asia Pacific Pty. Ltd.
+//
+// This file is part of Ready Trader Go.
+//
+//     Ready Trader Go is free software: you can redistribute it and/or
+//     modify it under the terms of the GNU Affero General Public License
+//     as published by the Free Software Foundation, either version 3 of
+//     the License, or (at your option) any later version.
+//
+//     Ready Trader Go is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU Affero General Public License for more details.
+//
+//     You should have received a copy of the GNU Affero General Public
+//     License along with Ready Trader Go.  If not, see
+//     <https://www.gnu.org/licenses/>.
+#ifndef CPPREADY_TRADER_GO_LIBS_READY_TRADER_GO_SIMULATOR_H
+#define CPPREADY_TRADER_GO_LIBS_READY_TRADER_GO_SIMULATOR_H
+
+#include <array>
+#include <cstddef>
+#include <deque>
+#include <limits>
+#include <memory>
+#include <set>
+#include <string>
+#include <unordered_map>
+
+#include <boost/property_tree/ptree.hpp>
+
+#include "baseautotrader.h"
+#include "connectivitytypes.h"
+#include "hedgeengine.h"
+#include "marketdata.h"
+#include "orderbook.h"
+#include "types.h"
+
+namespace ReadyTraderGo {
+
+// Large enough for any message exchanged with an auto-trader.
+constexpr std::size_t SIMULATED_MESSAGE_CAPACITY = 128;
+
+// The parts of the exchange configuration (exchange.json) that affect the
+// outcome of a simulated match.
+struct SimulatorConfig
+{
+    void readFromPropertyTree(const boost::property_tree::ptree& tree)
+    {
+        mMarketEventInterval = tree.get<double>("Engine.MarketEventInterval");
+        mTickInterval = tree.get<double>("Engine.TickInterval");
+
+        mMakerFee = tree.get<double>("Fees.Maker");
+        mTakerFee = tree.get<double>("Fees.Taker");
+
+        mEtfClamp = tree.get<double>("Instrument.EtfClamp");
+        mTickSize = tree.get<double>("Instrument.TickSize");
+
+        mActiveOrderCountLimit = tree.get<unsigned long>("Limits.ActiveOrderCountLimit");
+        mActiveVolumeLimit = tree.get<unsigned long>("Limits.ActiveVolumeLimit");
+        mMessageFrequencyInterval = tree.get<double>("Limits.MessageFrequencyInterval");
+        mMessageFrequencyLimit = tree.get<unsigned long>("Limits.MessageFrequencyLimit");
+        mPositionLimit = tree.get<long>("Limits.PositionLimit");
+    }
+
+    double mMarketEventInterval = 0.05;
+    double mTickInterval = 0.25;
+
+    double mMakerFee = -0.0001;
+    double mTakerFee = 0.0002;
+
+    double mEtfClamp = 0.002;
+    double mTickSize = 1.00;
+
+    unsigned long mActiveOrderCountLimit = 10;
+    unsigned long mActiveVolumeLimit = 200;
+    double mMessageFrequencyInterval = 1.0;
+    unsigned long mMessageFrequencyLimit = 50;
+    long mPositionLimit = 100;
+};
+
+// A competitor's account, valued at the last traded prices with the ETF
+// price clamped to within a band around the future price.
+class CompetitorAccount
+{
+public:
+    CompetitorAccount(double tickSize, double etfClamp)
+        : mEtfClamp(etfClamp), mTickSize(static_cast<long>(tickSize * 100.0)) {}
+
+    void Transact(Instrument instrument, Side side, unsigned long price, unsigned long volume, long fee);
+    void Update(long futurePrice, long etfPrice);
+
+    long mAccountBalance = 0;
+    unsigned long mBuyVolume = 0;
+    long mEtfPosition = 0;
+    long mFuturePosition = 0;
+    long mMaxDrawdown = 0;
+    long mMaxProfit = 0;
+    long mProfitOrLoss = 0;
+    unsigned long mSellVolume = 0;
+    long mTotalFees = 0;
+
+private:
+    double mEtfClamp;
+    long mTickSize;
+};
+
+// Limit the frequency of events in a specified time interval.
+class FrequencyLimiter
+{
+public:
+    FrequencyLimiter(double interval, unsigned long limit) : mInterval(interval), mLimit(limit) {}
+
+    // Return true if the new event breaches the limit. Must be called with a
+    // monotonically increasing sequence of times.
+    bool CheckEvent(double now);
+
+private:
+    std::deque<double> mEvents;
+    double mInterval;
+    unsigned long mLimit;
+};
+
+// A message passed between the simulator and the auto-trader.
+struct SimulatedMessage
+{
+    bool mIsInformation = false;
+    unsigned char mType = 0;
+    std::size_t mSize = 0;
+    std::array<unsigned char, SIMULATED_MESSAGE_CAPACITY> mData;
+};
+
+// An execution connection that hands messages to the simulator instead of a
+// socket. Messages are queued so that the simulator never re-enters the
+// auto-trader from inside one of its handlers.
+class SimulatedConnection : public IConnection
+{
+public:
+    explicit SimulatedConnection(std::deque<SimulatedMessage>& outbound) : mOutbound(outbound) {}
+
+    void AsyncRead() override {}
+    void Flush() override {}
+    void SendEncoded(unsigned char const* data, std::size_t size, SendMode mode) override;
+    void SendMessage(unsigned char messageType, const ISerialisable& serialisable, SendMode mode) override;
+
+    void Close() { OnDisconnect(); }
+    void Deliver(const SimulatedMessage& message) { OnMessageReceipt(message.mType, message.mData.data(), message.mSize); }
+
+private:
+    std::deque<SimulatedMessage>& mOutbound;
+};
+
+// An information subscription fed directly by the simulator.
+class SimulatedSubscription : public ISubscription
+{
+public:
+    void AsyncReceive() override {}
+
+    void Deliver(const SimulatedMessage& message) { OnMessageReceipt(message.mType, message.mData.data(), message.mSize); }
+};
+
+struct SimulationResult
+{
+    explicit SimulationResult(const SimulatorConfig& config) : mAccount(config.mTickSize, config.mEtfClamp) {}
+
+    CompetitorAccount mAccount;
+    std::string mStatus = "OK";
+    std::string mReason;
+    double mEndTime = 0.0;
+    unsigned long mMarketEventCount = 0;
+    unsigned long mMessageCount = 0;
+    unsigned long mErrorCount = 0;
+    unsigned long mFillCount = 0;
+    unsigned long mHedgeCount = 0;
+};
+
+// Replays market data through an auto-trader in simulated time, applying the
+// same rules, fees and limits as the Python matching engine. The auto-trader
+// sees no network or processing latency: its responses to each batch of
+// market events or information messages are handled at the same simulated
+// time.
+class Simulator : private IOrderListener
+{
+public:
+    Simulator(const SimulatorConfig& config, IMarketEventSource& events);
+
+    // Connect the auto-trader to the simulated exchange. It logs in
+    // immediately.
+    void Attach(BaseAutoTrader& autoTrader);
+
+    // Run the match to completion or until the auto-trader breaches a limit.
+    SimulationResult Run();
+
+private:
+    // Owns the market's resting orders so they can be amended and cancelled.
+    struct MarketOrders : public IOrderListener
+    {
+        void OnOrderAmended(double now, Order& order, unsigned long volumeRemoved) override;
+        void OnOrderCancelled(double now, Order& order, unsigned long volumeRemoved) override;
+        void OnOrderFilled(double now, Order& order, unsigned long price, unsigned long volume, long fee) override;
+
+        std::unordered_map<unsigned long, std::shared_ptr<Order>> mOrders[2];
+    };
+
+    // IOrderListener callbacks for the auto-trader's orders
+    void OnOrderAmended(double now, Order& order, unsigned long volumeRemoved) override;
+    void OnOrderCancelled(double now, Order& order, unsigned long volumeRemoved) override;
+    void OnOrderPlaced(double now, Order& order) override;
+    void OnOrderFilled(double now, Order& order, unsigned long price, unsigned long volume, long fee) override;
+
+    void OnAmendMessage(unsigned long clientOrderId, unsigned long volume);
+    void OnCancelMessage(unsigned long clientOrderId);
+    void OnHedgeMessage(unsigned long clientOrderId, Side side, unsigned long price, unsigned long volume);
+    void OnInsertMessage(unsigned long clientOrderId, Side side, unsigned long price, unsigned long volume,
+                         Lifespan lifespan);
+    void OnMessage(const SimulatedMessage& message);
+
+    void HardBreach(unsigned long clientOrderId, const std::string& message);
+    void ProcessMarketEvents();
+    void PublishOrderBooks(unsigned long tickNumber);
+    void PublishTradeTicks();
+    void RemoveOrder(Order& order);
+    void Send(bool isInformation, unsigned char messageType, const ISerialisable& serialisable);
+    void SendError(unsigned long clientOrderId, const std::string& message);
+    void Settle();
+
+    SimulatorConfig mConfig;
+    IMarketEventSource& mEvents;
+    OrderBook mFutureBook;
+    OrderBook mEtfBook;
+    MarketOrders mMarketOrders;
+    MarketEvent mNextEvent;
+    bool mHasNextEvent = true;
+    bool mHasTrades[2] = {false, false};
+    unsigned long mTradeTicksSequence[2] = {1, 1};
+
+    SimulationResult mResult;
+    FrequencyLimiter mLimiter;
+    UnhedgedLots mUnhedgedLots;
+    long mTickSize;
+    double mNow = 0.0;
+    bool mIsRunning = false;
+    bool mIsLoggedIn = false;
+
+    std::deque<SimulatedMessage> mFromAutoTrader;
+    std::deque<SimulatedMessage> mToAutoTrader;
+    SimulatedConnection* mConnection = nullptr;
+    SimulatedSubscription* mSubscription = nullptr;
+
+    std::unordered_map<unsigned long, std::shared_ptr<Order>> mOrders;
+    std::multiset<unsigned long> mBuyPrices;
+    std::multiset<unsigned long> mSellPrices;
+    unsigned long mActiveVolume = 0;
+    long mLastClientOrderId = -1;
+};
+
+}
+
+#endif //CPPREADY_TRADER_GO_LIBS_READY_TRADER_GO_SIMULATOR_H
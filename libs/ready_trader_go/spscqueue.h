@@ -0,0 +1,112 @@
+// Copyright 2021 Optiver Asia Pacific Pty. Ltd.
+//
+// This file is part of Ready Trader Go.
+//
+//     Ready Trader Go is free software: you can redistribute it and/or
+//     modify it under the terms of the GNU Affero General Public License
+//     as published by the Free Software Foundation, either version 3 of
+//     the License, or (at your option) any later version.
+//
+//     Ready Trader Go is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU Affero General Public License for more details.
+//
+//     You should have received a copy of the GNU Affero General Public
+//     License along with Ready Trader Go.  If not, see
+//     <https://www.gnu.org/licenses/>.
+#ifndef CPPREADY_TRADER_GO_LIBS_READY_TRADER_GO_SPSCQUEUE_H
+#define CPPREADY_TRADER_GO_LIBS_READY_TRADER_GO_SPSCQUEUE_H
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+
+#include "types.h"
+
+namespace ReadyTraderGo {
+
+// Spin-wait hint for busy loops.
+inline void cpuRelax() noexcept
+{
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__)
+    asm volatile("yield");
+#endif
+}
+
+// Bounded, lock-free queue for exactly one producer thread and one consumer
+// thread. The head and tail indices live on separate cache lines so that the
+// producer and consumer do not contend for the same line. Capacity must be a
+// power of two.
+template<typename T, std::size_t Capacity>
+class SpscQueue
+{
+    static_assert(Capacity > 0 && (Capacity & (Capacity - 1)) == 0, "capacity must be a power of two");
+
+public:
+    // Producer side: return a pointer to the next free slot, or nullptr if
+    // the queue is full. The slot becomes visible to the consumer on Push().
+    T* Claim() noexcept
+    {
+        const std::size_t tail = mTail.load(std::memory_order_relaxed);
+        if (tail - mCachedHead == Capacity)
+        {
+            mCachedHead = mHead.load(std::memory_order_acquire);
+            if (tail - mCachedHead == Capacity)
+                return nullptr;
+        }
+        return &mSlots[tail & (Capacity - 1)];
+    }
+
+    void Push() noexcept
+    {
+        mTail.store(mTail.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+    bool TryPush(const T& value) noexcept
+    {
+        T* slot = Claim();
+        if (slot == nullptr)
+            return false;
+        *slot = value;
+        Push();
+        return true;
+    }
+
+    // Consumer side: return a pointer to the oldest element, or nullptr if
+    // the queue is empty. The slot is released back to the producer on Pop().
+    T* Front() noexcept
+    {
+        const std::size_t head = mHead.load(std::memory_order_relaxed);
+        if (head == mCachedTail)
+        {
+            mCachedTail = mTail.load(std::memory_order_acquire);
+            if (head == mCachedTail)
+                return nullptr;
+        }
+        return &mSlots[head & (Capacity - 1)];
+    }
+
+    void Pop() noexcept
+    {
+        mHead.store(mHead.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+    bool Empty() const noexcept
+    {
+        return mHead.load(std::memory_order_acquire) == mTail.load(std::memory_order_acquire);
+    }
+
+private:
+    alignas(CACHE_LINE_SIZE) std::atomic<std::size_t> mHead{0};
+    std::size_t mCachedTail = 0;
+    alignas(CACHE_LINE_SIZE) std::atomic<std::size_t> mTail{0};
+    std::size_t mCachedHead = 0;
+    alignas(CACHE_LINE_SIZE) std::array<T, Capacity> mSlots{};
+};
+
+}
+
+#endif //CPPREADY_TRADER_GO_LIBS_READY_TRADER_GO_SPSCQUEUE_H
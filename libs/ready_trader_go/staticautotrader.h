@@ -0,0 +1,174 @@
+// Copyright 2021 Optiver Asia Pacific Pty. Ltd.
+//
+// This file is part of Ready Trader Go.
+//
+//     Ready Trader Go is free software: you can redistribute it and/or
+//     modify it under the terms of the GNU Affero General Public License
+//     as published by the Free Software Foundation, either version 3 of
+//     the License, or (at your option) any later version.
+//
+//     Ready Trader Go is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU Affero General Public License for more details.
+//
+//     You should have received a copy of the GNU Affero General Public
+//     License along with Ready Trader Go.  If not, see
+//     <https://www.gnu.org/licenses/>.
+#ifndef CPPREADY_TRADER_GO_LIBS_READY_TRADER_GO_STATICAUTOTRADER_H
+#define CPPREADY_TRADER_GO_LIBS_READY_TRADER_GO_STATICAUTOTRADER_H
+
+#include <cstddef>
+
+#include <boost/asio/io_context.hpp>
+
+#include "baseautotrader.h"
+#include "latency.h"
+#include "protocol.h"
+
+namespace ReadyTraderGo {
+
+// An auto-trader base class that dispatches each received message directly
+// to the handlers of Derived rather than through virtual calls, so that the
+// compiler can inline the decode and the strategy's handler into the
+// callback installed on the connection. Derived should be declared final and
+// hides the handlers it implements; handlers it does not implement fall back
+// to those of BaseAutoTrader.
+//
+// For example:
+//
+//     class AutoTrader final : public ReadyTraderGo::StaticAutoTrader<AutoTrader>
+//
+// A StaticAutoTrader is still a BaseAutoTrader and can be used anywhere one
+// is expected.
+template<typename Derived>
+class StaticAutoTrader : public BaseAutoTrader
+{
+public:
+    explicit StaticAutoTrader(boost::asio::io_context& context) : BaseAutoTrader(context) {};
+
+protected:
+    void BindHandlers(IConnection& connection) override;
+    void BindHandlers(ISubscription& subscription) override;
+
+    void MessageHandler(IConnection* connection,
+                        unsigned char messageType,
+                        unsigned char const* data,
+                        std::size_t size) final;
+    void MessageHandler(ISubscription* subscription,
+                        unsigned char messageType,
+                        unsigned char const* data,
+                        std::size_t size) final;
+
+private:
+    Derived& GetDerived() { return static_cast<Derived&>(*this); }
+
+    void DispatchExecutionMessage(unsigned char messageType, unsigned char const* data, std::size_t size);
+    void DispatchInformationMessage(unsigned char messageType, unsigned char const* data, std::size_t size);
+};
+
+template<typename Derived>
+void StaticAutoTrader<Derived>::BindHandlers(IConnection& connection)
+{
+    connection.Disconnected = [this] { GetDerived().DisconnectHandler(); };
+    connection.MessageReceived = [this](IConnection*,
+                                        unsigned char t,
+                                        unsigned char const* d,
+                                        std::size_t s) { DispatchExecutionMessage(t, d, s); };
+}
+
+template<typename Derived>
+void StaticAutoTrader<Derived>::BindHandlers(ISubscription& subscription)
+{
+    subscription.MessageReceived = [this](ISubscription*,
+                                          unsigned char t,
+                                          unsigned char const* d,
+                                          std::size_t z) { DispatchInformationMessage(t, d, z); };
+}
+
+template<typename Derived>
+void StaticAutoTrader<Derived>::MessageHandler(IConnection*,
+                                               unsigned char messageType,
+                                               unsigned char const* data,
+                                               std::size_t size)
+{
+    DispatchExecutionMessage(messageType, data, size);
+}
+
+template<typename Derived>
+void StaticAutoTrader<Derived>::MessageHandler(ISubscription*,
+                                               unsigned char messageType,
+                                               unsigned char const* data,
+                                               std::size_t size)
+{
+    DispatchInformationMessage(messageType, data, size);
+}
+
+template<typename Derived>
+inline void StaticAutoTrader<Derived>::DispatchExecutionMessage(unsigned char messageType,
+                                                                unsigned char const* data,
+                                                                std::size_t size)
+{
+    SendBatch batch(*this);
+
+    switch (messageType)
+    {
+    case MessageType::ERROR_MESSAGE:
+    {
+        auto err = BeforeErrorMessage(data, size);
+        GetDerived().ErrorMessageHandler(err.mClientOrderId, err.mMessage);
+        break;
+    }
+    case MessageType::HEDGE_FILLED:
+    {
+        auto filled = BeforeHedgeFilledMessage(data, size);
+        GetDerived().HedgeFilledMessageHandler(filled.mClientOrderId, filled.mPrice, filled.mVolume);
+        break;
+    }
+    case MessageType::ORDER_FILLED:
+    {
+        auto filled = BeforeOrderFilledMessage(data, size);
+        GetDerived().OrderFilledMessageHandler(filled.mClientOrderId, filled.mPrice, filled.mVolume);
+        break;
+    }
+    case MessageType::ORDER_STATUS:
+    {
+        auto status = BeforeOrderStatusMessage(data, size);
+        GetDerived().OrderStatusMessageHandler(status.mClientOrderId, status.mFillVolume,
+                                               status.mRemainingVolume, status.mFees);
+        break;
+    }
+    default:
+        UnexpectedMessage("execution", messageType);
+    }
+    RTG_LATENCY_POINT(HandlerExited());
+}
+
+template<typename Derived>
+inline void StaticAutoTrader<Derived>::DispatchInformationMessage(unsigned char messageType,
+                                                                  unsigned char const* data,
+                                                                  std::size_t size)
+{
+    SendBatch batch(*this);
+
+    switch (messageType)
+    {
+    case MessageType::ORDER_BOOK_UPDATE:
+        GetDerived().OrderBookMessageHandler(BeforeOrderBookMessage(data, size));
+        break;
+    case MessageType::TRADE_TICKS:
+    {
+        auto ticks = BeforeTradeTicksMessage(data, size);
+        GetDerived().TradeTicksMessageHandler(ticks.mInstrument, ticks.mSequenceNumber, ticks.mAskPrices,
+                                              ticks.mAskVolumes, ticks.mBidPrices, ticks.mBidVolumes);
+        break;
+    }
+    default:
+        UnexpectedMessage("information", messageType);
+    }
+    RTG_LATENCY_POINT(HandlerExited());
+}
+
+}
+
+#endif //CPPREADY_TRADER_GO_LIBS_READY_TRADER_GO_STATICAUTOTRADER_H
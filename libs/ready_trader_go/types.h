@@ -27,6 +27,7 @@ namespace ReadyTraderGo {
 constexpr unsigned long MAXIMUM_ASK = 4294967295;
 constexpr unsigned long MINIMUM_BID = 0;
 constexpr std::size_t TOP_LEVEL_COUNT = 5;
+constexpr std::size_t CACHE_LINE_SIZE = 64;
 
 enum class Instrument : unsigned char { FUTURE, ETF };
 enum class Lifespan : unsigned char { FILL_AND_KILL, GOOD_FOR_DAY };
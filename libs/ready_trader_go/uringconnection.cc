@@ -0,0 +1,536 @@
+// Copyright 2021 Optiver Asia Pacific Pty. Ltd.
+//
+// This file is part of Ready Trader Go.
+//
+//     Ready Trader Go is free software: you can redistribute it and/or
+//     modify it under the terms of the GNU Affero General Public License
+//     as published by the Free Software Foundation, either version 3 of
+//     the License, or (at your option) any later version.
+//
+//     Ready Trader Go is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU Affero General Public License for more details.
+//
+//     You should have received a copy of the GNU Affero General Public
+//     License along with Ready Trader Go.  If not, see
+//     <https://www.gnu.org/licenses/>.
+#include "uringconnection.h"
+
+#if defined(RTG_IO_URING)
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <iomanip>
+#include <string>
+
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <boost/asio/post.hpp>
+#include <boost/endian/conversion.hpp>
+
+#include "error.h"
+#include "latency.h"
+#include "logging.h"
+
+RTG_INLINE_GLOBAL_LOGGER_WITH_CHANNEL(LG_URING, "CON")
+
+namespace ReadyTraderGo {
+
+// Number of submission queue entries: enough to hand back every receive
+// buffer alongside a receive and a send.
+constexpr unsigned URING_QUEUE_DEPTH = 2 * URING_RECEIVE_BUFFER_COUNT;
+
+// Milliseconds the SQPOLL thread spins without work before it sleeps.
+constexpr unsigned URING_SQPOLL_IDLE = 1000;
+
+constexpr unsigned short URING_RECEIVE_BUFFER_GROUP = 0;
+
+bool IsUringAvailable() noexcept
+{
+    return true;
+}
+
+static int uringSetup(unsigned entries, io_uring_params* params)
+{
+    return static_cast<int>(syscall(__NR_io_uring_setup, entries, params));
+}
+
+static int uringEnter(int ring, unsigned toSubmit, unsigned minComplete, unsigned flags)
+{
+    return static_cast<int>(syscall(__NR_io_uring_enter, ring, toSubmit, minComplete, flags, nullptr, 0));
+}
+
+static void* mapOrThrow(std::size_t size, int fd, off_t offset, const char* what)
+{
+    void* memory = (fd < 0)
+                   ? mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_POPULATE, -1, 0)
+                   : mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, offset);
+    if (memory == MAP_FAILED)
+    {
+        throw ReadyTraderGoError(std::string("failed to map io_uring ") + what + ": " + std::strerror(errno));
+    }
+    return memory;
+}
+
+template<typename T>
+static T* at(void* base, unsigned offset)
+{
+    return reinterpret_cast<T*>(static_cast<unsigned char*>(base) + offset);
+}
+
+UringConnection::UringConnection(boost::asio::io_context& context, int socket, bool isSqPoll, int sqPollCpu)
+    : mContext(context), mSocket(socket), mIsSqPoll(isSqPoll)
+{
+    SetName("uring:" + std::to_string(socket));
+
+    try
+    {
+        io_uring_params params{};
+        if (mIsSqPoll)
+        {
+            params.flags |= IORING_SETUP_SQPOLL;
+            params.sq_thread_idle = URING_SQPOLL_IDLE;
+            if (sqPollCpu >= 0)
+            {
+                params.flags |= IORING_SETUP_SQ_AFF;
+                params.sq_thread_cpu = static_cast<unsigned>(sqPollCpu);
+            }
+        }
+
+        mRing = uringSetup(URING_QUEUE_DEPTH, &params);
+        if (mRing < 0)
+        {
+            throw ReadyTraderGoError(std::string("io_uring_setup failed: ") + std::strerror(errno));
+        }
+
+        mSqRingSize = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+        mCqRingSize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+        if (params.features & IORING_FEAT_SINGLE_MMAP)
+        {
+            mSqRingSize = mCqRingSize = std::max(mSqRingSize, mCqRingSize);
+        }
+        mSqRingMemory = mapOrThrow(mSqRingSize, mRing, IORING_OFF_SQ_RING, "submission queue");
+        mCqRingMemory = (params.features & IORING_FEAT_SINGLE_MMAP)
+                        ? mSqRingMemory
+                        : mapOrThrow(mCqRingSize, mRing, IORING_OFF_CQ_RING, "completion queue");
+        mSqesSize = params.sq_entries * sizeof(io_uring_sqe);
+        mSqes = static_cast<io_uring_sqe*>(mapOrThrow(mSqesSize, mRing, IORING_OFF_SQES, "submission entries"));
+
+        mSqHead = at<unsigned>(mSqRingMemory, params.sq_off.head);
+        mSqTail = at<unsigned>(mSqRingMemory, params.sq_off.tail);
+        mSqFlags = at<unsigned>(mSqRingMemory, params.sq_off.flags);
+        mSqArray = at<unsigned>(mSqRingMemory, params.sq_off.array);
+        mSqMask = *at<unsigned>(mSqRingMemory, params.sq_off.ring_mask);
+        mCqHead = at<unsigned>(mCqRingMemory, params.cq_off.head);
+        mCqTail = at<unsigned>(mCqRingMemory, params.cq_off.tail);
+        mCqes = at<io_uring_cqe>(mCqRingMemory, params.cq_off.cqes);
+        mCqMask = *at<unsigned>(mCqRingMemory, params.cq_off.ring_mask);
+
+        mReceiveBuffers = static_cast<unsigned char*>(
+            mapOrThrow(URING_RECEIVE_BUFFER_COUNT * URING_RECEIVE_BUFFER_SIZE, -1, 0, "receive buffers"));
+        mSendBuffers = static_cast<unsigned char*>(mapOrThrow(2 * URING_SEND_BUFFER_SIZE, -1, 0, "send buffers"));
+
+        ProvideBuffers(0, URING_RECEIVE_BUFFER_COUNT);
+        Submit();
+    }
+    catch (...)
+    {
+        Close();
+        throw;
+    }
+
+    RLOG(LG_URING, LogLevel::LL_INFO) << std::quoted(mName, '\'') << " using io_uring"
+                                      << (mIsSqPoll ? " with SQPOLL" : "");
+    Poll();
+}
+
+UringConnection::~UringConnection()
+{
+    RLOG(LG_URING, LogLevel::LL_INFO) << std::quoted(mName, '\'') << " closing";
+    Close();
+}
+
+void UringConnection::Close() noexcept
+{
+    mIsClosed = true;
+    if (mSocket >= 0)
+    {
+        shutdown(mSocket, SHUT_RDWR);
+    }
+    if (mRing >= 0)
+    {
+        close(mRing);
+        mRing = -1;
+    }
+    if (mSocket >= 0)
+    {
+        close(mSocket);
+        mSocket = -1;
+    }
+
+    if (mSendBuffers)
+        munmap(mSendBuffers, 2 * URING_SEND_BUFFER_SIZE);
+    if (mReceiveBuffers)
+        munmap(mReceiveBuffers, URING_RECEIVE_BUFFER_COUNT * URING_RECEIVE_BUFFER_SIZE);
+    if (mSqes)
+        munmap(mSqes, mSqesSize);
+    if (mCqRingMemory && mCqRingMemory != mSqRingMemory)
+        munmap(mCqRingMemory, mCqRingSize);
+    if (mSqRingMemory)
+        munmap(mSqRingMemory, mSqRingSize);
+    mSendBuffers = mReceiveBuffers = nullptr;
+    mSqes = nullptr;
+    mSqRingMemory = mCqRingMemory = nullptr;
+}
+
+void UringConnection::AsyncRead()
+{
+    SubmitReceive();
+}
+
+io_uring_sqe* UringConnection::NextSqe()
+{
+    const unsigned tail = *mSqTail + mToSubmit;
+    if (tail - __atomic_load_n(mSqHead, __ATOMIC_ACQUIRE) > mSqMask)
+    {
+        throw ReadyTraderGoError("io_uring submission queue full");
+    }
+
+    io_uring_sqe* sqe = &mSqes[tail & mSqMask];
+    std::memset(sqe, 0, sizeof(*sqe));
+    mSqArray[tail & mSqMask] = tail & mSqMask;
+    ++mToSubmit;
+    return sqe;
+}
+
+void UringConnection::Submit()
+{
+    if (mToSubmit == 0)
+    {
+        return;
+    }
+
+    const unsigned count = mToSubmit;
+    mToSubmit = 0;
+    __atomic_store_n(mSqTail, *mSqTail + count, __ATOMIC_RELEASE);
+
+    if (mIsSqPoll)
+    {
+        // The SQPOLL thread only needs waking if it has gone to sleep.
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if ((__atomic_load_n(mSqFlags, __ATOMIC_RELAXED) & IORING_SQ_NEED_WAKEUP) == 0)
+        {
+            return;
+        }
+        if (uringEnter(mRing, 0, 0, IORING_ENTER_SQ_WAKEUP) < 0)
+        {
+            throw ReadyTraderGoError(std::string("io_uring_enter failed: ") + std::strerror(errno));
+        }
+        return;
+    }
+
+    int result;
+    do
+    {
+        result = uringEnter(mRing, count, 0, 0);
+    }
+    while (result < 0 && errno == EINTR);
+    if (result < 0)
+    {
+        throw ReadyTraderGoError(std::string("io_uring_enter failed: ") + std::strerror(errno));
+    }
+}
+
+void UringConnection::Poll()
+{
+    std::weak_ptr<bool> isAlive = mIsAlive;
+    boost::asio::post(mContext, [this, isAlive] {
+        if (!isAlive.expired() && !mIsClosed)
+        {
+            Reap();
+            Poll();
+        }
+    });
+}
+
+void UringConnection::Reap()
+{
+    unsigned head = *mCqHead;
+    while (!mIsClosed && head != __atomic_load_n(mCqTail, __ATOMIC_ACQUIRE))
+    {
+        const io_uring_cqe cqe = mCqes[head & mCqMask];
+        __atomic_store_n(mCqHead, ++head, __ATOMIC_RELEASE);
+
+        switch (cqe.user_data)
+        {
+        case PROVIDE:
+            // Only failures are reported.
+            RLOG(LG_URING, LogLevel::LL_ERROR) << std::quoted(mName, '\'') << " failed to provide receive buffers: "
+                                               << std::strerror(-cqe.res);
+            throw ReadyTraderGoError(std::string("failed to provide receive buffers: ") + std::strerror(-cqe.res));
+        case RECEIVE:
+            ReceiveHandler(cqe);
+            break;
+        case SEND:
+            SendHandler(cqe);
+            break;
+        }
+    }
+
+    // Hand back any used buffers that did not go out with a send.
+    if (!mIsClosed)
+    {
+        Submit();
+    }
+}
+
+void UringConnection::ProvideBuffers(unsigned short bufferId, unsigned count)
+{
+    io_uring_sqe* sqe = NextSqe();
+    sqe->opcode = IORING_OP_PROVIDE_BUFFERS;
+    sqe->fd = static_cast<int>(count);
+    sqe->addr = reinterpret_cast<std::uint64_t>(mReceiveBuffers + bufferId * URING_RECEIVE_BUFFER_SIZE);
+    sqe->len = URING_RECEIVE_BUFFER_SIZE;
+    sqe->off = bufferId;
+    sqe->buf_group = URING_RECEIVE_BUFFER_GROUP;
+    sqe->flags = IOSQE_CQE_SKIP_SUCCESS;
+    sqe->user_data = PROVIDE;
+}
+
+void UringConnection::SubmitReceive()
+{
+    io_uring_sqe* sqe = NextSqe();
+    sqe->opcode = IORING_OP_RECV;
+    sqe->fd = mSocket;
+    sqe->ioprio = IORING_RECV_MULTISHOT;
+    sqe->flags = IOSQE_BUFFER_SELECT;
+    sqe->buf_group = URING_RECEIVE_BUFFER_GROUP;
+    sqe->user_data = RECEIVE;
+    Submit();
+}
+
+void UringConnection::ReceiveHandler(const io_uring_cqe& cqe)
+{
+    const std::uint64_t receivedAt = LatencyTimestamp();
+
+    if (cqe.res <= 0)
+    {
+        if (cqe.res == -ENOBUFS || cqe.res == -EINTR || cqe.res == -EAGAIN)
+        {
+            // Used buffers are handed back ahead of the new receive, so it
+            // can simply be re-armed.
+            if ((cqe.flags & IORING_CQE_F_MORE) == 0)
+            {
+                SubmitReceive();
+            }
+            return;
+        }
+
+        if (cqe.res == 0)
+        {
+            RLOG(LG_URING, LogLevel::LL_INFO) << std::quoted(mName, '\'') << " remote disconnect";
+        }
+        else
+        {
+            RLOG(LG_URING, LogLevel::LL_ERROR) << std::quoted(mName, '\'') << " read error: "
+                                               << std::strerror(-cqe.res);
+        }
+        mIsClosed = true;
+        OnDisconnect();
+        return;
+    }
+
+    const auto bufferId = static_cast<unsigned short>(cqe.flags >> IORING_CQE_BUFFER_SHIFT);
+    const auto size = static_cast<std::size_t>(cqe.res);
+    RLOG(LG_URING, LogLevel::LL_DEBUG) << std::quoted(mName, '\'') << " received " << size << " bytes";
+    if (size > mInBuffer.Free())
+    {
+        RLOG(LG_URING, LogLevel::LL_ERROR) << std::quoted(mName, '\'') << " receive buffer full";
+        mIsClosed = true;
+        OnDisconnect();
+        return;
+    }
+    mInBuffer.Write(mReceiveBuffers + bufferId * URING_RECEIVE_BUFFER_SIZE, size);
+    ProvideBuffers(bufferId, 1);
+
+    if ((cqe.flags & IORING_CQE_F_MORE) == 0)
+    {
+        SubmitReceive();
+    }
+
+    if (!DeliverMessages(receivedAt))
+    {
+        mIsClosed = true;
+        OnDisconnect();
+    }
+}
+
+unsigned char* UringConnection::Reserve(std::size_t size)
+{
+    std::size_t& filled = mSendSize[mFilling];
+    if (filled + size > URING_SEND_BUFFER_SIZE)
+    {
+        RLOG(LG_URING, LogLevel::LL_ERROR) << std::quoted(mName, '\'') << " send buffer full, "
+                                           << filled << " bytes pending";
+        throw ReadyTraderGoError("send buffer full");
+    }
+
+    unsigned char* data = mSendBuffers + mFilling * URING_SEND_BUFFER_SIZE + filled;
+    filled += size;
+    return data;
+}
+
+void UringConnection::SendEncoded(unsigned char const* data, std::size_t size, SendMode mode)
+{
+    std::memcpy(Reserve(size), data, size);
+    Send(mode);
+}
+
+void UringConnection::SendMessage(unsigned char messageType, const ISerialisable& serialisable, SendMode mode)
+{
+    const std::size_t size = MESSAGE_HEADER_SIZE + serialisable.Size();
+    unsigned char* data = Reserve(size);
+    *(uint16_t*)data = boost::endian::native_to_big((uint16_t)size);
+    data[MESSAGE_TYPE_OFFSET] = messageType;
+    serialisable.Serialise(data + MESSAGE_HEADER_SIZE);
+    Send(mode);
+}
+
+void UringConnection::Send(SendMode mode)
+{
+    if (mIsSending)
+    {
+        // Written by SendHandler once the send in progress completes.
+        RTG_LATENCY_POINT(WriteDeferred());
+        return;
+    }
+    if (mode == SendMode::DEFERRED)
+    {
+        return;
+    }
+
+    if (mode == SendMode::ASAP)
+    {
+        StartSend();
+        return;
+    }
+
+    // Written once control returns to the io_context.
+    RTG_LATENCY_POINT(WriteDeferred());
+    if (!mIsSendPosted)
+    {
+        std::weak_ptr<bool> isAlive = mIsAlive;
+        boost::asio::post(mContext, [this, isAlive] {
+            if (!isAlive.expired())
+            {
+                mIsSendPosted = false;
+                StartSend();
+            }
+        });
+        mIsSendPosted = true;
+    }
+}
+
+void UringConnection::Flush()
+{
+    StartSend();
+}
+
+void UringConnection::StartSend()
+{
+    if (mIsSending || mIsClosed || mSendSize[mFilling] == 0)
+    {
+        return;
+    }
+
+    // Send the filled buffer and fill the other one meanwhile.
+    mFilling ^= 1;
+    mSendOffset = 0;
+    mIsSending = true;
+    SubmitSend();
+    // Resubmitting the rest of a partly sent buffer is not a new write.
+    RTG_LATENCY_POINT(SocketWritten());
+}
+
+void UringConnection::SubmitSend()
+{
+    const int sending = mFilling ^ 1;
+    io_uring_sqe* sqe = NextSqe();
+    sqe->opcode = IORING_OP_SEND;
+    sqe->fd = mSocket;
+    sqe->addr = reinterpret_cast<std::uint64_t>(mSendBuffers + sending * URING_SEND_BUFFER_SIZE + mSendOffset);
+    sqe->len = static_cast<unsigned>(mSendSize[sending] - mSendOffset);
+    sqe->msg_flags = MSG_NOSIGNAL;
+    sqe->user_data = SEND;
+    Submit();
+}
+
+void UringConnection::SendHandler(const io_uring_cqe& cqe)
+{
+    const int sending = mFilling ^ 1;
+    if (cqe.res < 0)
+    {
+        if (cqe.res != -EINTR && cqe.res != -EAGAIN)
+        {
+            RLOG(LG_URING, LogLevel::LL_ERROR) << std::quoted(mName, '\'') << " send failed: "
+                                               << std::strerror(-cqe.res);
+            throw ReadyTraderGoError(std::string("send failed: ") + std::strerror(-cqe.res));
+        }
+        RLOG(LG_URING, LogLevel::LL_DEBUG) << std::quoted(mName, '\'') << " send interrupted: "
+                                           << std::strerror(-cqe.res);
+        SubmitSend();
+        return;
+    }
+
+    RLOG(LG_URING, LogLevel::LL_DEBUG) << std::quoted(mName, '\'') << " sent " << cqe.res << " bytes";
+    mSendOffset += static_cast<std::size_t>(cqe.res);
+    if (mSendOffset < mSendSize[sending])
+    {
+        SubmitSend();
+        return;
+    }
+
+    mSendSize[sending] = 0;
+    mIsSending = false;
+    StartSend();
+}
+
+}
+
+#else
+
+#include <unistd.h>
+
+#include "error.h"
+
+namespace ReadyTraderGo {
+
+bool IsUringAvailable() noexcept
+{
+    return false;
+}
+
+UringConnection::UringConnection(boost::asio::io_context& context, int socket, bool isSqPoll, int)
+    : mContext(context), mSocket(socket), mIsSqPoll(isSqPoll)
+{
+    close(mSocket);
+    throw ReadyTraderGoError("this build does not include the io_uring transport");
+}
+
+UringConnection::~UringConnection() = default;
+
+void UringConnection::AsyncRead() {}
+void UringConnection::Flush() {}
+void UringConnection::SendEncoded(unsigned char const*, std::size_t, SendMode) {}
+void UringConnection::SendMessage(unsigned char, const ISerialisable&, SendMode) {}
+
+}
+
+#endif
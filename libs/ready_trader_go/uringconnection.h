@@ -0,0 +1,130 @@
+// Copyright 2021 Optiver Asia Pacific Pty. Ltd.
+//
+// This file is part of Ready Trader Go.
+//
+//     Ready Trader Go is free software: you can redistribute it and/or
+//     modify it under the terms of the GNU Affero General Public License
+//     as published by the Free Software Foundation, either version 3 of
+//     the License, or (at your option) any later version.
+//
+//     Ready Trader Go is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU Affero General Public License for more details.
+//
+//     You should have received a copy of the GNU Affero General Public
+//     License along with Ready Trader Go.  If not, see
+//     <https://www.gnu.org/licenses/>.
+#ifndef CPPREADY_TRADER_GO_LIBS_READY_TRADER_GO_URINGCONNECTION_H
+#define CPPREADY_TRADER_GO_LIBS_READY_TRADER_GO_URINGCONNECTION_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+#include <boost/asio/io_context.hpp>
+
+#include "connectivity.h"
+
+struct io_uring_cqe;
+struct io_uring_sqe;
+
+namespace ReadyTraderGo {
+
+// Number of buffers the kernel may fill with received data before they are
+// handed back, and the size of each.
+constexpr std::size_t URING_RECEIVE_BUFFER_COUNT = 16;
+constexpr std::size_t URING_RECEIVE_BUFFER_SIZE = 4096;
+
+// Size of each of the two send buffers. Messages are serialised into one
+// buffer while the other is being sent.
+constexpr std::size_t URING_SEND_BUFFER_SIZE = CONNECTION_BUFFER_SIZE / 2;
+
+// True if this build includes the io_uring transport.
+bool IsUringAvailable() noexcept;
+
+// An execution connection that talks to the kernel through an io_uring
+// instead of the io_context's reactor.
+//
+// A single multishot receive, armed once, fills buffers provided to the
+// kernel up front, and messages are sent from two preallocated buffers, so
+// neither direction needs a system call per message or an allocation per
+// operation. Used buffers are handed back to the kernel in the same
+// submission as the next send. With SQPOLL a kernel thread picks up
+// submissions and the connection makes no system calls at all.
+//
+// Completions are reaped by a handler that re-posts itself to the
+// io_context, in the same way as the information subscription's poll mode,
+// so the event loop never sleeps while the connection is open.
+class UringConnection : public StreamConnection
+{
+public:
+    // Takes ownership of a connected, non-blocking socket. If sqPollCpu is
+    // not negative the SQPOLL thread is pinned to that CPU.
+    UringConnection(boost::asio::io_context& context, int socket, bool isSqPoll, int sqPollCpu = -1);
+    ~UringConnection() override;
+
+    void AsyncRead() override;
+    void Flush() override;
+    void SendEncoded(unsigned char const* data, std::size_t size, SendMode mode) override;
+    void SendMessage(unsigned char messageType, const ISerialisable& serialisable, SendMode mode) override;
+
+private:
+    enum Operation : std::uint64_t { PROVIDE, RECEIVE, SEND };
+
+    io_uring_sqe* NextSqe();
+    void Submit();
+    void Poll();
+    void Reap();
+    void ReceiveHandler(const io_uring_cqe& cqe);
+    void SendHandler(const io_uring_cqe& cqe);
+    void ProvideBuffers(unsigned short bufferId, unsigned count);
+    unsigned char* Reserve(std::size_t size);
+    void Send(SendMode mode);
+    void StartSend();
+    void SubmitReceive();
+    void SubmitSend();
+    void Close() noexcept;
+
+    boost::asio::io_context& mContext;
+    int mSocket;
+    int mRing = -1;
+    bool mIsSqPoll;
+    bool mIsClosed = false;
+    bool mIsSendPosted = false;
+    // Expires when the connection is destroyed so posted handlers can tell.
+    std::shared_ptr<bool> mIsAlive = std::make_shared<bool>(true);
+
+    // Submission and completion queues shared with the kernel.
+    void* mSqRingMemory = nullptr;
+    std::size_t mSqRingSize = 0;
+    void* mCqRingMemory = nullptr;
+    std::size_t mCqRingSize = 0;
+    io_uring_sqe* mSqes = nullptr;
+    std::size_t mSqesSize = 0;
+    unsigned* mSqHead = nullptr;
+    unsigned* mSqTail = nullptr;
+    unsigned* mSqFlags = nullptr;
+    unsigned* mSqArray = nullptr;
+    unsigned mSqMask = 0;
+    unsigned mToSubmit = 0;
+    unsigned* mCqHead = nullptr;
+    unsigned* mCqTail = nullptr;
+    io_uring_cqe* mCqes = nullptr;
+    unsigned mCqMask = 0;
+
+    // Buffers provided to the kernel for the multishot receive.
+    unsigned char* mReceiveBuffers = nullptr;
+
+    // Send buffers: one is filled while the other is in flight.
+    unsigned char* mSendBuffers = nullptr;
+    std::array<std::size_t, 2> mSendSize{};
+    std::size_t mSendOffset = 0;
+    int mFilling = 0;
+    bool mIsSending = false;
+};
+
+}
+
+#endif //CPPREADY_TRADER_GO_LIBS_READY_TRADER_GO_URINGCONNECTION_H
@@ -0,0 +1,167 @@
+// Copyright 2021 Optiver Asia Pacific Pty. Ltd.
+//
+// This file is part of Ready Trader Go.
+//
+//     Ready Trader Go is free software: you can redistribute it and/or
+//     modify it under the terms of the GNU Affero General Public License
+//     as published by the Free Software Foundation, either version 3 of
+//     the License, or (at your option) any later version.
+//
+//     Ready Trader Go is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU Affero General Public License for more details.
+//
+//     You should have received a copy of the GNU Affero General Public
+//     License along with Ready Trader Go.  If not, see
+//     <https://www.gnu.org/licenses/>.
+#include <utility>
+
+#include "workstealingpool.h"
+
+namespace ReadyTraderGo {
+
+namespace {
+
+// Index of the pool worker running on this thread, if any.
+thread_local WorkStealingPool const* currentPool = nullptr;
+thread_local std::size_t currentWorker = 0;
+
+}
+
+WorkStealingPool::WorkStealingPool(std::size_t workerCount)
+{
+    if (workerCount == 0)
+    {
+        workerCount = 1;
+    }
+
+    mWorkers.reserve(workerCount);
+    for (std::size_t i = 0; i < workerCount; ++i)
+    {
+        mWorkers.push_back(std::make_unique<Worker>());
+    }
+
+    mThreads.reserve(workerCount);
+    for (std::size_t i = 0; i < workerCount; ++i)
+    {
+        mThreads.emplace_back([this, i] { Run(i); });
+    }
+}
+
+WorkStealingPool::~WorkStealingPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mIsStopping = true;
+    }
+    mWorkAvailable.notify_all();
+    for (auto& thread : mThreads)
+    {
+        thread.join();
+    }
+}
+
+void WorkStealingPool::Submit(std::function<void()> task)
+{
+    std::size_t index = (currentPool == this)
+                        ? currentWorker
+                        : mNextWorker.fetch_add(1, std::memory_order_relaxed) % mWorkers.size();
+    {
+        std::lock_guard<std::mutex> lock(mWorkers[index]->mMutex);
+        mWorkers[index]->mTasks.push_back(std::move(task));
+    }
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        ++mQueuedCount;
+        ++mPendingCount;
+    }
+    mWorkAvailable.notify_one();
+}
+
+void WorkStealingPool::Wait()
+{
+    std::unique_lock<std::mutex> lock(mMutex);
+    mAllDone.wait(lock, [this] { return mPendingCount == 0; });
+    if (mError)
+    {
+        std::rethrow_exception(std::exchange(mError, nullptr));
+    }
+}
+
+bool WorkStealingPool::TryTake(std::size_t index, std::function<void()>& task)
+{
+    {
+        Worker& own = *mWorkers[index];
+        std::lock_guard<std::mutex> lock(own.mMutex);
+        if (!own.mTasks.empty())
+        {
+            task = std::move(own.mTasks.back());
+            own.mTasks.pop_back();
+            return true;
+        }
+    }
+
+    for (std::size_t i = 1; i < mWorkers.size(); ++i)
+    {
+        Worker& victim = *mWorkers[(index + i) % mWorkers.size()];
+        std::lock_guard<std::mutex> lock(victim.mMutex);
+        if (!victim.mTasks.empty())
+        {
+            task = std::move(victim.mTasks.front());
+            victim.mTasks.pop_front();
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void WorkStealingPool::Run(std::size_t index)
+{
+    currentPool = this;
+    currentWorker = index;
+
+    std::function<void()> task;
+    for (;;)
+    {
+        {
+            std::unique_lock<std::mutex> lock(mMutex);
+            mWorkAvailable.wait(lock, [this] { return mIsStopping || mQueuedCount > 0; });
+            if (mQueuedCount == 0)
+            {
+                return;
+            }
+            --mQueuedCount;
+        }
+
+        // Tasks are queued before they are counted and only workers holding
+        // a reservation take them, so one of the queues holds a task for us.
+        while (!TryTake(index, task))
+        {
+            std::this_thread::yield();
+        }
+
+        try
+        {
+            task();
+        }
+        catch (...)
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            if (!mError)
+            {
+                mError = std::current_exception();
+            }
+        }
+        task = nullptr;
+
+        std::lock_guard<std::mutex> lock(mMutex);
+        if (--mPendingCount == 0)
+        {
+            mAllDone.notify_all();
+        }
+    }
+}
+
+}
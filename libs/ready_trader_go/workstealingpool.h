@@ -0,0 +1,81 @@
+// Copyright 2021 Optiver Asia Pacific Pty. Ltd.
+//
+// This file is part of Ready Trader Go.
+//
+//     Ready Trader Go is free software: you can redistribute it and/or
+//     modify it under the terms of the GNU Affero General Public License
+//     as published by the Free Software Foundation, either version 3 of
+//     the License, or (at your option) any later version.
+//
+//     Ready Trader Go is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU Affero General Public License for more details.
+//
+//     You should have received a copy of the GNU Affero General Public
+//     License along with Ready Trader Go.  If not, see
+//     <https://www.gnu.org/licenses/>.
+#ifndef CPPREADY_TRADER_GO_LIBS_READY_TRADER_GO_WORKSTEALINGPOOL_H
+#define CPPREADY_TRADER_GO_LIBS_READY_TRADER_GO_WORKSTEALINGPOOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace ReadyTraderGo {
+
+// A fixed-size pool of threads for running independent, long-running tasks
+// such as simulations. Each worker has its own queue which it takes work
+// from the back of; an idle worker steals from the front of the other
+// workers' queues so that uneven tasks keep every core busy.
+class WorkStealingPool
+{
+public:
+    explicit WorkStealingPool(std::size_t workerCount = std::thread::hardware_concurrency());
+    ~WorkStealingPool();
+
+    WorkStealingPool(const WorkStealingPool&) = delete;
+    WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+    std::size_t GetWorkerCount() const noexcept { return mWorkers.size(); }
+
+    // Queue a task. Tasks submitted from a worker go to that worker's queue.
+    void Submit(std::function<void()> task);
+
+    // Block until every submitted task has finished. Rethrows the first
+    // exception thrown by a task, if any.
+    void Wait();
+
+private:
+    struct Worker
+    {
+        std::mutex mMutex;
+        std::deque<std::function<void()>> mTasks;
+    };
+
+    bool TryTake(std::size_t index, std::function<void()>& task);
+    void Run(std::size_t index);
+
+    std::vector<std::unique_ptr<Worker>> mWorkers;
+    std::vector<std::thread> mThreads;
+    std::atomic<std::size_t> mNextWorker{0};
+
+    std::mutex mMutex;
+    std::condition_variable mWorkAvailable;
+    std::condition_variable mAllDone;
+    std::size_t mQueuedCount = 0;
+    std::size_t mPendingCount = 0;
+    bool mIsStopping = false;
+    std::exception_ptr mError;
+};
+
+}
+
+#endif //CPPREADY_TRADER_GO_LIBS_READY_TRADER_GO_WORKSTEALINGPOOL_H
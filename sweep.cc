@@ -0,0 +1,320 @@
+// Copyright 2021 Optiver Asia Pacific Pty. Ltd.
+//
+// This file is part of Ready Trader Go.
+//
+//     Ready Trader Go is free software: you can redistribute it and/or
+//     modify it under the terms of the GNU Affero General Public License
+//     as published by the Free Software Foundation, either version 3 of
+//     the License, or (at your option) any later version.
+//
+//     Ready Trader Go is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU Affero General Public License for more details.
+//
+//     You should have received a copy of the GNU Affero General Public
+//     License along with Ready Trader Go.  If not, see
+//     <https://www.gnu.org/licenses/>.
+#include <algorithm>
+#include <cstdlib>
+#include <exception>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <boost/asio/io_context.hpp>
+#include <boost/log/core/core.hpp>
+#include <boost/property_tree/json_parser.hpp>
+#include <boost/property_tree/ptree.hpp>
+
+#include <ready_trader_go/error.h>
+#include <ready_trader_go/marketdata.h>
+#include <ready_trader_go/simulator.h>
+#include <ready_trader_go/workstealingpool.h>
+
+#include "autotrader.h"
+
+using namespace ReadyTraderGo;
+
+namespace {
+
+struct SweepRun
+{
+    AutoTraderParameters mParameters;
+    std::string mFilename;
+    std::string mStatus;
+    long mProfitOrLoss = 0;
+    long mMaxDrawdown = 0;
+    long mTotalFees = 0;
+    long mEtfPosition = 0;
+    unsigned long mBuyVolume = 0;
+    unsigned long mSellVolume = 0;
+    unsigned long mFillCount = 0;
+    unsigned long mHedgeCount = 0;
+    unsigned long mMessageCount = 0;
+    unsigned long mErrorCount = 0;
+};
+
+template<typename T>
+std::vector<T> parseList(const std::string& text)
+{
+    std::vector<T> values;
+    std::istringstream stream{text};
+    std::string item;
+    while (std::getline(stream, item, ','))
+    {
+        std::istringstream itemStream{item};
+        T value;
+        if (!(itemStream >> value) || !itemStream.eof())
+        {
+            throw ReadyTraderGoError("invalid value in list: '" + text + "'");
+        }
+        values.push_back(value);
+    }
+    if (values.empty())
+    {
+        throw ReadyTraderGoError("empty list");
+    }
+    return values;
+}
+
+void runOne(const SimulatorConfig& config, SweepRun& run)
+{
+    try
+    {
+        auto events = OpenMarketData(run.mFilename);
+        boost::asio::io_context context;
+        AutoTrader trader{context, run.mParameters};
+        trader.SetLoginDetails("Sweep", "secret");
+
+        Simulator simulator{config, *events};
+        simulator.Attach(trader);
+        SimulationResult result = simulator.Run();
+
+        const CompetitorAccount& account = result.mAccount;
+        run.mStatus = result.mStatus;
+        run.mProfitOrLoss = account.mProfitOrLoss;
+        run.mMaxDrawdown = account.mMaxDrawdown;
+        run.mTotalFees = account.mTotalFees;
+        run.mEtfPosition = account.mEtfPosition;
+        run.mBuyVolume = account.mBuyVolume;
+        run.mSellVolume = account.mSellVolume;
+        run.mFillCount = result.mFillCount;
+        run.mHedgeCount = result.mHedgeCount;
+        run.mMessageCount = result.mMessageCount;
+        run.mErrorCount = result.mErrorCount;
+    }
+    catch (const std::exception& e)
+    {
+        // Reported as this run's status, and counted as a breach, rather than
+        // abandoning the runs that did complete. Kept to one CSV field.
+        run.mStatus = std::string("ERROR: ") + e.what();
+        std::replace_if(run.mStatus.begin(), run.mStatus.end(), [](char c) { return c == ',' || c == '\n'; }, ' ');
+    }
+}
+
+void writeRuns(const std::string& filename, const std::vector<SweepRun>& runs)
+{
+    std::ofstream out{filename};
+    if (!out)
+    {
+        throw ReadyTraderGoError("failed to open output file: " + filename);
+    }
+
+    out << "WindowSize,BandWidth,LotSize,PositionLimit,HedgeWindow,MarketDataFile,Status,ProfitOrLoss,MaxDrawdown,"
+           "TotalFees,EtfPosition,BuyVolume,SellVolume,Fills,Hedges,Messages,Errors\n";
+    for (const SweepRun& run : runs)
+    {
+        const AutoTraderParameters& p = run.mParameters;
+        out << p.windowSize << ',' << p.bandWidth << ',' << p.lotSize << ',' << p.positionLimit << ','
+            << p.hedgeWindow << ',' << run.mFilename << ',' << run.mStatus << ',' << run.mProfitOrLoss << ',' << run.mMaxDrawdown << ','
+            << run.mTotalFees << ',' << run.mEtfPosition << ',' << run.mBuyVolume << ',' << run.mSellVolume << ','
+            << run.mFillCount << ',' << run.mHedgeCount << ',' << run.mMessageCount << ','
+            << run.mErrorCount << '\n';
+    }
+}
+
+// Print one line per grid point, best total profit first.
+void printSummary(const std::vector<SweepRun>& runs, std::size_t fileCount)
+{
+    struct Summary
+    {
+        AutoTraderParameters mParameters;
+        long mTotalProfit = 0;
+        long mWorstProfit = 0;
+        long mWorstDrawdown = 0;
+        unsigned long mFillCount = 0;
+        unsigned long mBreachCount = 0;
+    };
+
+    std::vector<Summary> summaries;
+    for (std::size_t i = 0; i < runs.size(); i += fileCount)
+    {
+        Summary summary;
+        summary.mParameters = runs[i].mParameters;
+        summary.mWorstProfit = runs[i].mProfitOrLoss;
+        for (std::size_t j = i; j < i + fileCount; ++j)
+        {
+            summary.mTotalProfit += runs[j].mProfitOrLoss;
+            summary.mWorstProfit = std::min(summary.mWorstProfit, runs[j].mProfitOrLoss);
+            summary.mWorstDrawdown = std::max(summary.mWorstDrawdown, runs[j].mMaxDrawdown);
+            summary.mFillCount += runs[j].mFillCount;
+            summary.mBreachCount += (runs[j].mStatus != "OK");
+        }
+        summaries.push_back(summary);
+    }
+
+    std::sort(summaries.begin(), summaries.end(),
+              [](const Summary& a, const Summary& b) { return a.mTotalProfit > b.mTotalProfit; });
+
+    std::cout << std::setw(8) << "window" << std::setw(8) << "band" << std::setw(6) << "lot"
+              << std::setw(7) << "limit" << std::setw(8) << "hedge" << std::setw(14) << "total pnl" << std::setw(14) << "worst pnl"
+              << std::setw(14) << "worst dd" << std::setw(8) << "fills" << std::setw(10) << "breaches" << '\n'
+              << std::fixed << std::setprecision(2);
+    for (const Summary& s : summaries)
+    {
+        const AutoTraderParameters& p = s.mParameters;
+        std::cout << std::setw(8) << p.windowSize << std::setw(8) << p.bandWidth << std::setw(6) << p.lotSize
+                  << std::setw(7) << p.positionLimit << std::setw(8) << p.hedgeWindow
+                  << std::setw(14) << s.mTotalProfit / 100.0
+                  << std::setw(14) << s.mWorstProfit / 100.0 << std::setw(14) << s.mWorstDrawdown / 100.0
+                  << std::setw(8) << s.mFillCount << std::setw(10) << s.mBreachCount << '\n';
+    }
+    std::cout.flush();
+}
+
+void usage(const char* name)
+{
+    const AutoTraderParameters defaults;
+    std::cerr << "usage: " << name << " [options] MARKET_DATA_FILE...\n"
+                 "\n"
+                 "Replay each market data file through the auto-trader for every combination\n"
+                 "of the parameters below. Lists are comma separated.\n"
+                 "\n"
+              << "  --window LIST          moving average window sizes (default " << defaults.windowSize << ")\n"
+              << "  --band LIST            bollinger band widths (default " << defaults.bandWidth << ")\n"
+              << "  --lot LIST             lot sizes (default " << defaults.lotSize << ")\n"
+              << "  --position-limit LIST  position limits (default " << defaults.positionLimit << ")\n"
+              << "  --hedge-window LIST    seconds over which fills are netted into one hedge (default "
+              << defaults.hedgeWindow << ")\n"
+                 "  --threads N            worker threads (default: one per core)\n"
+                 "  --output FILE          per-run results (default sweep.csv)\n"
+                 "\n"
+                 "Binary market data files (see convertmarketdata) are shared between runs\n"
+                 "through the page cache; CSV files are parsed by every run."
+              << std::endl;
+}
+
+}
+
+int main(int argc, char* argv[])
+{
+    AutoTraderParameters defaults;
+    std::vector<unsigned long> windowSizes{defaults.windowSize};
+    std::vector<float> bandWidths{defaults.bandWidth};
+    std::vector<long> lotSizes{defaults.lotSize};
+    std::vector<long> positionLimits{defaults.positionLimit};
+    std::vector<double> hedgeWindows{defaults.hedgeWindow};
+    std::size_t threadCount = std::thread::hardware_concurrency();
+    std::string outputFilename = "sweep.csv";
+    std::vector<std::string> filenames;
+
+    try
+    {
+        for (int i = 1; i < argc; ++i)
+        {
+            std::string arg = argv[i];
+            auto value = [&]() -> std::string
+            {
+                if (++i == argc)
+                {
+                    throw ReadyTraderGoError("missing value for " + arg);
+                }
+                return argv[i];
+            };
+
+            if (arg == "--window")
+                windowSizes = parseList<unsigned long>(value());
+            else if (arg == "--band")
+                bandWidths = parseList<float>(value());
+            else if (arg == "--lot")
+                lotSizes = parseList<long>(value());
+            else if (arg == "--position-limit")
+                positionLimits = parseList<long>(value());
+            else if (arg == "--hedge-window")
+                hedgeWindows = parseList<double>(value());
+            else if (arg == "--threads")
+                threadCount = parseList<std::size_t>(value()).front();
+            else if (arg == "--output")
+                outputFilename = value();
+            else if (arg == "--help" || arg == "-h" || arg.rfind("--", 0) == 0)
+            {
+                usage(argv[0]);
+                return (arg == "--help" || arg == "-h") ? EXIT_SUCCESS : EXIT_FAILURE;
+            }
+            else
+                filenames.push_back(arg);
+        }
+
+        if (filenames.empty())
+        {
+            usage(argv[0]);
+            return EXIT_FAILURE;
+        }
+
+        // The auto-trader's logging would dominate the run time.
+        boost::log::core::get()->set_logging_enabled(false);
+
+        boost::property_tree::ptree tree;
+        boost::property_tree::read_json("exchange.json", tree);
+        SimulatorConfig config;
+        config.readFromPropertyTree(tree);
+
+        // Runs for the same grid point are adjacent so they can be summarised.
+        std::vector<SweepRun> runs;
+        for (unsigned long windowSize : windowSizes)
+            for (float bandWidth : bandWidths)
+                for (long lotSize : lotSizes)
+                    for (long positionLimit : positionLimits)
+                        for (double hedgeWindow : hedgeWindows)
+                            for (const std::string& filename : filenames)
+                            {
+                                SweepRun& run = runs.emplace_back();
+                                run.mParameters = AutoTraderParameters{windowSize, bandWidth, lotSize, positionLimit,
+                                                                       hedgeWindow};
+                                run.mFilename = filename;
+                            }
+
+        std::cerr << "running " << runs.size() << " replays on " << threadCount << " threads" << std::endl;
+        WorkStealingPool pool{threadCount};
+        for (SweepRun& run : runs)
+        {
+            pool.Submit([&config, &run] { runOne(config, run); });
+        }
+        pool.Wait();
+
+        writeRuns(outputFilename, runs);
+        printSummary(runs, filenames.size());
+    }
+    catch (const boost::property_tree::ptree_error& e)
+    {
+        std::cerr << "failed while reading configuration: " << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+    catch (const ReadyTraderGoError& e)
+    {
+        std::cerr << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << "sweep failed: " << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}